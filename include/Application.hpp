@@ -3,6 +3,11 @@
 #include <SDL3/SDL.h>
 //window constraints
 #include <constraints.hpp>
+#include <spatial_grid.hpp>
+#include <camera.hpp>
+#include <render_batch.hpp>
+#include <label_atlas.hpp>
+#include <heat_map.hpp>
 
 #include <iostream>
 #include <vector>
@@ -15,7 +20,13 @@
 #include <gate_and.hpp>
 #include <gate_or.hpp>
 #include <gate_not.hpp>
-#include <json.hpp>
+#include <gate_box.hpp>
+#include <component_pool.hpp>
+
+//simulation
+#include <netlist.hpp>
+#include <sim_worker.hpp>
+#include <atomic>
 
 
 class Application{
@@ -25,28 +36,89 @@ class Application{
 
         bool init();
         void run();
+
+        // @brief
+        // most frames per second while something is changing, 0 = no cap
+        // an idle application doesn't draw at all
+        void setFrameCap(int fps) { frameCap = fps; }
+
+        // @brief
+        // simulation ticks per second, independent of the frame rate, 0 = as fast as possible
+        void setTickRate(double ticksPerSecond) { simWorker.setTickRate(ticksPerSecond); }
     
     private:
         SDL_Window* window = nullptr;
         SDL_Renderer* renderer = nullptr;
         TTF_Font* font = nullptr;
+        SDL_Texture* gridTexture = nullptr; //one tile of the background grid, repeated over the screen
+        RenderBatch batch; //shapes of the frame, kept between frames so its buffers are reused
+        LabelAtlas labels; //one texture region per distinct label text
+        HeatMap heatMap;   //the far view, drawn instead of the components below LOD_HEATMAP_ZOOM
         bool isRunning = true;
 
+        //render on demand, frames are only drawn while something changed
+        int redrawFrames = 2; //frames still to draw, imgui needs a second one to settle hover/layout
+        int frameCap = 0;
+        void requestRedraw() { redrawFrames = 2; }
+
+        //views of the netlist nodes, components[i] draws node i (nullptr once removed)
+        //they live in per-kind arenas, clearing the scene is an arena reset
+        ComponentPool componentPool;
         std::vector<Component*> components;
+        SpatialGrid spatialIndex; //hit-testing and culling, keyed by node id
+
+        //view, only what the camera sees is submitted
+        Camera camera;
+        int viewWidth = SCREEN_WIDTH; //render output in pixels, the window can be resized
+        int viewHeight = SCREEN_HEIGHT;
+        std::vector<int> nearby; //components around the view this frame, in draw order
+
+        // @brief
+        // a wire is the input port of its reader
+        struct WireRef{
+            int node;
+            int port;
+        };
+        //wires longer than LONG_WIRE_LENGTH on an axis, the spatial index can't find them from
+        //their ends, so they are tested against the view one by one, rebuilt after edits and drops
+        std::vector<WireRef> longWires;
+
+        //simulation
+        Netlist netlist;
+        //the simulation runs on its own thread, it gets every edit of the netlist and
+        //publishes the node states as snapshots, render() draws the latest one
+        SimWorker simWorker;
+        Uint32 simEventType = 0;              //pushed by the worker to wake the frame loop
+        std::atomic<bool> simEventPosted{false}; //one wakeup in flight is enough
 
         //interaction
-        Component* selectedComponent = nullptr;
-        Component* wiringSource = nullptr;
+        //handles instead of pointers, they resolve to nothing once the node is gone
+        NodeHandle selected;
+        NodeHandle wiringFrom;
         bool isWiring = false;
-        float mouseX = 0;
+        bool isPanning = false;
+        int rejectedWidth = 0; //out of range width typed in the inspector for rejectedNode, 0 if none
+        int rejectedNode = -1;
+        float screenX = 0; //cursor in screen pixels
+        float screenY = 0;
+        float mouseX = 0;  //world point under the cursor
         float mouseY = 0;
 
         //helper functions
         void handleEvents();
         void update();
         void render();
+        void renderOverlay();
         void cleanup();
+        void buildGridTexture();
+        void drawGrid();
         void saveCircuit(const std::string&);
         void loadCircuit(const std::string&);
+        Component* createComponent(GateType type, float x, float y);
+        Component* createView(int node);
+        Component* view(NodeHandle h);
+        void indexComponent(Component* comp);
+        Component* pick(float mx, float my, HitZone& zone, int& port);
+        void collectLongWires();
 };
 #endif // APPLICATION_HPP
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef CAMERA_HPP
+#define CAMERA_HPP
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <constraints.hpp>
+
+// @brief
+// the part of the canvas that is on screen
+// world coordinates are the ones of the netlist, screen = (world - origin) * zoom
+struct Camera{
+    float x = 0; //world point at the top left corner of the screen
+    float y = 0;
+    float zoom = 1;
+
+    SDL_FPoint toScreen(float wx, float wy) const {
+        return {(wx - x) * zoom, (wy - y) * zoom};
+    }
+    SDL_FPoint toWorld(float sx, float sy) const {
+        return {sx / zoom + x, sy / zoom + y};
+    }
+
+    // @brief
+    // moves the view by a distance in screen pixels, the canvas follows the mouse
+    void pan(float dx, float dy){
+        x -= dx / zoom;
+        y -= dy / zoom;
+    }
+
+    // @brief
+    // scales the view by factor, the world point under (sx, sy) stays where it is
+    void zoomAt(float sx, float sy, float factor){
+        SDL_FPoint anchor = toWorld(sx, sy);
+        zoom = std::clamp(zoom * factor, CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+        x = anchor.x - sx / zoom;
+        y = anchor.y - sy / zoom;
+    }
+
+    // @brief
+    // world rect covered by a screen of the given size
+    SDL_FRect visible(float screenWidth, float screenHeight) const {
+        return {x, y, screenWidth / zoom, screenHeight / zoom};
+    }
+};
+
+// @brief
+// true if the segment crosses the rect or lies inside it (liang-barsky clipping)
+inline bool segmentIntersectsRect(float x0, float y0, float x1, float y1, const SDL_FRect& r){
+    float t0 = 0, t1 = 1;
+    const float dx = x1 - x0, dy = y1 - y0;
+    const float p[4] = {-dx, dx, -dy, dy};
+    const float q[4] = {x0 - r.x, r.x + r.w - x0, y0 - r.y, r.y + r.h - y0};
+    for (int k = 0; k < 4; k++){
+        if (p[k] == 0){
+            if (q[k] < 0) return false; //parallel to that edge and outside of it
+            continue;
+        }
+        float t = q[k] / p[k];
+        if (p[k] < 0) { if (t > t1) return false; if (t > t0) t0 = t; }
+        else          { if (t < t0) return false; if (t < t1) t1 = t; }
+    }
+    return true;
+}
+#endif // CAMERA_HPP
@@ -3,19 +3,17 @@
 #include <SDL3/SDL.h>
 #include <SDL_ttf.h>
 #include <string>
-struct Pin
-{
-    int x, y;
-    bool *val;
-};
+#include <render_batch.hpp>
+#include <label_atlas.hpp>
+#include <netlist.hpp>
 
 // @brief
 // this allows us to identify which part of the component we are clicking on
+// HIT_INPUT comes with the index of the port that was hit
 enum HitZone{
     HIT_NONE,
     HIT_BODY,
-    HIT_INPUT1,
-    HIT_INPUT2,
+    HIT_INPUT,
     HIT_OUTPUT
 };
 // @brief
@@ -25,57 +23,100 @@ class Component
 public:
     float x, y;
     int width, height;
-    bool outputState;
     bool isDragging;
     float dragOffsetX, dragOffsetY;
+    GateType type; //type tag, the ports come from its gateInfo() row
+    int inputs;    //input ports, n-input gates can have more than their type's default
+    int netId = -1; //node of this component in the netlist
 
-    std::string labelText;
-    SDL_Texture* labelTexture = nullptr;//the image of the text
-    int labelWidth = 0;
-    int labelHeight = 0;
+    const char* labelText; //a literal, components own nothing so their pools can drop them at once
+    int labelId = -1; //the image of the text, shared through the label atlas
 
 
-    Component(float startX, float startY, std::string labelText="") : x(startX), y(startY),
-                                            width(60), height(40), outputState(false),
-                                            isDragging(false), dragOffsetX(0), dragOffsetY(0) {};
+    Component(GateType type, float startX, float startY, const char* labelText="") : x(startX), y(startY),
+                                            width(60), height(40),
+                                            isDragging(false), dragOffsetX(0), dragOffsetY(0),
+                                            type(type), inputs(gateInfo(type).inputs), labelText(labelText) {};
 
-    virtual ~Component() {
-        if(labelTexture){
-            SDL_DestroyTexture(labelTexture);
-        }
-    };
+    //no virtual destructor on purpose: components live in typed pools and are never deleted
+    //through a Component*, a trivial destructor is what lets ComponentPool::reset() skip them
 
     // core logic
+    // the logic and the output state live in the netlist (node netId), a component is only its view
+
+    // 1. the face : adds its shapes to the frame's batch, state is the simulated output of the node
+    virtual void draw(RenderBatch& batch, bool state) = 0;
 
-    // 1. brain : updates outputState based on inputs
-    // it is "= 0" because a generic component doesn't know how to calculate.
     // @brief
-    // function to calculate the output state of a component
-    virtual void calculate() = 0;
+    // fill color of the body, gates are blue whatever their output
+    virtual SDL_Color bodyColor(bool /*state*/) const { return {0, 100, 255, 255}; }
 
-    // 2. the face : draws specific shape
-    virtual void draw(SDL_Renderer *renderer) = 0;
+    // @brief
+    // the face when zoomed out (LOD_SIMPLE_ZOOM): the body alone, no pins, border or label
+    void drawSimple(RenderBatch& batch, bool state) const {
+        batch.fillRect({x, y, (float)width, (float)height}, bodyColor(state));
+    }
+
+    // 2. ports : where the wires attach, the same for every type
+    // the wiring itself is netlist data (Netlist::input / Netlist::connect on netId)
+    int numInputs() const { return inputs; }
+
+    // @brief
+    // follows the input count of the node, past two inputs the body grows 20 pixels per pin
+    void setInputCount(int n) {
+        inputs = n;
+        if (gateInfo(type).variadic) height = n > 2 ? 20 * n : 40;
+    }
+    bool hasOutput() const { return gateInfo(type).output; }
+
+    // @brief
+    // position of an input pin, the wire of that port ends here
+    // a single input sits in the middle of the left side, more are spread 10 pixels from the corners
+    SDL_FPoint inputPin(int port) const {
+        int n = numInputs();
+        if (n <= 1) return {x, y + height/2};
+        return {x, y + 10 + (float)(height - 20) * port / (n - 1)};
+    }
+
+    // @brief
+    // position of the output pin, wires to the readers start here
+    SDL_FPoint outputPin() const {
+        return {x + width, y + height/2};
+    }
+
+    // @brief
+    // the white pin squares of every port
+    void drawPins(RenderBatch& batch) const {
+        SDL_Color white = {255, 255, 255, 255};
+        for (int port = 0; port < numInputs(); port++) {
+            SDL_FPoint pin = inputPin(port);
+            batch.fillRect({ pin.x - 5, pin.y - 5, 10, 10 }, white);
+        }
+        if (hasOutput()) {
+            SDL_FPoint pin = outputPin();
+            batch.fillRect({ pin.x - 5, pin.y - 5, 10, 10 }, white);
+        }
+    }
 
     // 3. hit detection
     // @brief
     // function to detect the zone hit by the mouse when pressing click
-    virtual HitZone getHitZone(float mx, float my) {
+    // pins reach 10 pixels around their center, port is set for HIT_INPUT
+    HitZone getHitZone(float mx, float my, int& port) const {
+        auto near = [&](SDL_FPoint pin) {
+            return mx >= pin.x - 10 && mx <= pin.x + 10 && my >= pin.y - 10 && my <= pin.y + 10;
+        };
         // check output pin
-        if (mx >= x + width - 10 && mx <= x + width + 10 &&
-            my >= y + height/2 - 10 && my <= y + height/2 + 10) {
+        if (hasOutput() && near(outputPin())) {
             return HIT_OUTPUT;
         }
 
-        // check input1
-        if (mx >= x - 10 && mx <= x + 10 &&
-            my >= y + 10 - 10 && my <= y + 10 + 10) {
-            return HIT_INPUT1;
-        }
-
-        // check input2
-        if (mx >= x - 10 && mx <= x + 10 &&
-            my >= y + height - 10 - 10 && my <= y + height - 10 + 10) {
-            return HIT_INPUT2;
+        // check the inputs
+        for (int p = 0; p < numInputs(); p++) {
+            if (near(inputPin(p))) {
+                port = p;
+                return HIT_INPUT;
+            }
         }
 
         // check body
@@ -89,48 +130,23 @@ public:
     //4. label generation
 
     // @brief
-    // helper to generate text image
-    void createLabelTexture(SDL_Renderer* renderer, TTF_Font* font){
-        if(labelText.empty() || !font){
-            return;
-        }
-
-        //destroy old texture if it exists
-        if(labelTexture) SDL_DestroyTexture(labelTexture);
-
-        //render text to a temporary surface
-        SDL_Color color = {255,255,255,255}; //white text color;
-        SDL_Surface* surface = TTF_RenderText_Blended(font, labelText.c_str(),0,color);
-
-        if(surface){
-            //convert surface to gpu texture
-            labelTexture = SDL_CreateTextureFromSurface(renderer,surface);
-            labelWidth = surface->w;
-            labelHeight = surface->h;
-            SDL_DestroySurface(surface);//free the CPU surface
-        }
+    // helper to get the text image, identical labels share one
+    void createLabel(LabelAtlas& atlas, TTF_Font* font){
+        labelId = labelText[0] ? atlas.get(font, labelText) : -1;
     }
 
-
-
     // @brief
-    // function to draw the text of each component
-    void drawLabel(SDL_Renderer* renderer){
-        if(labelTexture){
+    // function to queue the text of each component, the atlas draws all of them at once
+    void drawLabel(LabelAtlas& atlas){
+        if(labelId >= 0){
+            const LabelAtlas::Label& label = atlas.label(labelId);
             //center the text
-            float textX = x + (width-labelWidth)/2;
-            float textY = y -labelHeight -5; //5 pixels above
+            float textX = x + (width-label.src.w)/2;
+            float textY = y -label.src.h -5; //5 pixels above
 
-            SDL_FRect dstRect = {textX, textY, (float)labelWidth, (float)labelHeight};
-            SDL_RenderTexture(renderer, labelTexture, NULL, &dstRect);
+            atlas.queue(labelId, textX, textY);
         }
     }
-
-
-    // @brief
-    // function to return a status json of each component implemented
-    // must be pure virtual, each child must implement their own version based on necessities
-    virtual std::string getType() = 0;
 };
 
 #endif // COMPONENT_HPP
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef COMPONENT_POOL_HPP
+#define COMPONENT_POOL_HPP
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <netlist.hpp>
+#include <component.hpp>
+#include <input_switch.hpp>
+#include <output_light.hpp>
+#include <gate_and.hpp>
+#include <gate_or.hpp>
+#include <gate_not.hpp>
+#include <gate_box.hpp>
+
+// @brief
+// arena of one component type: objects are carved out of fixed blocks that are never given back
+// a destroyed object's slot goes on a free list, reset() forgets every object in O(1)
+// and the blocks are reused by the next creations, so loading a circuit allocates nothing
+template<typename T, size_t BLOCK = 1024>
+class Arena{
+    static_assert(std::is_trivially_destructible<T>::value, "reset() doesn't run destructors");
+
+    public:
+        template<typename... Args>
+        T* create(Args&&... args){
+            void* memory;
+            if (!freeSlots.empty()){
+                memory = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else{
+                if (used == blocks.size() * BLOCK)
+                    blocks.emplace_back(new Slot[BLOCK]);
+                memory = &blocks[used / BLOCK][used % BLOCK];
+                used++;
+            }
+            return new (memory) T(std::forward<Args>(args)...);
+        }
+
+        void destroy(T* item){
+            freeSlots.push_back(item);
+        }
+
+        void reset(){
+            used = 0;
+            freeSlots.clear();
+        }
+
+    private:
+        struct alignas(T) Slot{
+            unsigned char bytes[sizeof(T)];
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> blocks;
+        std::vector<void*> freeSlots;
+        size_t used = 0; //slots handed out from the blocks, in order
+};
+
+// @brief
+// one arena per component kind, what Application allocates its views from
+class ComponentPool{
+    public:
+        Component* create(GateType type, float x, float y){
+            switch (type){
+                case GATE_AND: return ands.create(x, y);
+                case GATE_OR: return ors.create(x, y);
+                case GATE_NOT: return nots.create(x, y);
+                case GATE_SWITCH: return switches.create(x, y);
+                case GATE_LIGHT: return lights.create(x, y);
+                case GATE_XOR:
+                case GATE_ADD:
+                case GATE_MUX:
+                case GATE_EQ:
+                case GATE_LT:
+                case GATE_NAND:
+                case GATE_NOR:
+                case GATE_XNOR:
+                case GATE_DFF:
+                case GATE_REG:
+                case GATE_COUNTER:
+                case GATE_CLOCK: return boxes.create(type, x, y);
+                default: return nullptr;
+            }
+        }
+
+        // @brief
+        // gives the component's slot back, type must be the kind it was created as
+        void destroy(Component* comp, GateType type){
+            switch (type){
+                case GATE_AND: ands.destroy(static_cast<And_Gate*>(comp)); break;
+                case GATE_OR: ors.destroy(static_cast<Or_Gate*>(comp)); break;
+                case GATE_NOT: nots.destroy(static_cast<Not_Gate*>(comp)); break;
+                case GATE_SWITCH: switches.destroy(static_cast<Input_Switch*>(comp)); break;
+                case GATE_LIGHT: lights.destroy(static_cast<Output_Light*>(comp)); break;
+                case GATE_XOR:
+                case GATE_ADD:
+                case GATE_MUX:
+                case GATE_EQ:
+                case GATE_LT:
+                case GATE_NAND:
+                case GATE_NOR:
+                case GATE_XNOR:
+                case GATE_DFF:
+                case GATE_REG:
+                case GATE_COUNTER:
+                case GATE_CLOCK: boxes.destroy(static_cast<Box_Gate*>(comp)); break;
+                default: break;
+            }
+        }
+
+        // @brief
+        // drops every component at once, every pointer into the pool is invalid afterwards
+        void reset(){
+            ands.reset();
+            ors.reset();
+            nots.reset();
+            switches.reset();
+            lights.reset();
+            boxes.reset();
+        }
+
+    private:
+        Arena<And_Gate> ands;
+        Arena<Or_Gate> ors;
+        Arena<Not_Gate> nots;
+        Arena<Input_Switch> switches;
+        Arena<Output_Light> lights;
+        Arena<Box_Gate> boxes;
+};
+#endif // COMPONENT_POOL_HPP
@@ -0,0 +1,35 @@
+#ifndef GATE_BOX_HPP
+#define GATE_BOX_HPP
+#include <component.hpp>
+#include <SDL.h>
+
+// @brief
+// class that defines the word level parts (XOR, ADD, MUX, EQ, LT), the inverting gates (NAND, NOR, XNOR)
+// and the clocked ones (DFF, REG, COUNTER, CLOCK)
+// they only differ by their gateInfo() row, so one labeled box draws all of them
+class Box_Gate: public Component{
+    public:
+        Box_Gate(GateType type, float x, float y):Component(type,x,y,gateInfo(type).name){
+            width = 60;
+            height = numInputs() > 2 ? 60 : 40; //room for the select pin of a mux
+        }
+
+        // @brief
+        // a clock shows its level like a switch, the parts that hold state are purple
+        SDL_Color bodyColor(bool state) const override{
+            if (type == GATE_CLOCK) return state ? SDL_Color{0, 255, 0, 255} : SDL_Color{200, 0, 0, 255};
+            if (gateInfo(type).sequential) return {130, 60, 200, 255};
+            return {0, 100, 255, 255};
+        }
+
+        void draw(RenderBatch& batch, bool state) override{
+            //add connection nodes (white)
+            drawPins(batch);
+
+            //gate object
+            SDL_FRect rect = {x,y,(float)width, (float)height};
+            batch.fillRect(rect, bodyColor(state));
+            batch.rect(rect, {255,255,255,255});
+        }
+};
+#endif // GATE_BOX_HPP
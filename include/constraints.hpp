@@ -1,6 +1,16 @@
 #ifndef CONSTRAINTS_HPP
-#define CONSTRAINTS_HP
+#define CONSTRAINTS_HPP
 constexpr int SCREEN_WIDTH = 1280;
 constexpr int SCREEN_HEIGHT = 720;
 constexpr int GRID_SIZE = 10;
+constexpr int IDLE_WAIT_MS = 500; //longest sleep of an idle frame loop, events wake it earlier
+constexpr int GRID_TILE_SIZE = 8 * GRID_SIZE; //edge of the cached grid tile
+constexpr float CAMERA_MIN_ZOOM = 0.01f; //far enough to see a million gates at once
+constexpr float CAMERA_MAX_ZOOM = 4.0f;
+constexpr float LONG_WIRE_LENGTH = 400; //wires reaching further than this on an axis are culled on their own
+//level of detail: full gates above LOD_SIMPLE_ZOOM, plain rects down to LOD_HEATMAP_ZOOM, a heat map below
+constexpr float LOD_SIMPLE_ZOOM = 0.5f;
+constexpr float LOD_HEATMAP_ZOOM = 0.2f;
+constexpr int HEAT_TEXEL = 4;        //screen pixels per heat map texel
+constexpr int HEAT_FULL_COUNT = 64;  //nodes in a texel for full brightness
 #endif // CONSTRAINTS_HPP
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef BATCH_SIMULATOR_HPP
+#define BATCH_SIMULATOR_HPP
+#include <simulator.hpp>
+#include <lanes.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//most inputs exhaustive() runs, 2^32 patterns is already hours of output
+constexpr int EXHAUSTIVE_MAX_INPUTS = 32;
+
+// @brief
+// bit-parallel simulation mode, every net holds one Word so each gate evaluates
+// Lanes<Word>::COUNT independent test vectors per instruction (64, 256 or 512)
+// it runs the same levelized program as Simulator, useful for truth-table checks
+// a lane is one bit, so only programs without buses fit (Program::wide is false)
+// it keeps its own copy of the program, a later compile() of the Simulator does not touch it
+template<typename Word>
+class BatchSimulator{
+    public:
+        explicit BatchSimulator(Program source) : program(std::move(source)),
+            nets(program.netCount + 1, Lanes<Word>::broadcast(false)) {}
+
+        int inputCount() const { return (int)program.sources.size(); }
+        int outputCount() const { return (int)program.probes.size(); }
+
+        // @brief
+        // input k is the k-th switch, output k the k-th light, both in component order
+        void setInput(int k, const Word& lanes){
+            nets[program.sources[k]] = lanes;
+        }
+        const Word& output(int k) const {
+            return nets[program.probes[k]];
+        }
+        const Word& net(int id) const {
+            return nets[id];
+        }
+
+        // @brief
+        // one pass over the program, settles all lanes at once
+        // loops are swept until no lane changes, like Simulator does, capped at LOOP_SWEEP_LIMIT
+        void evaluate(){
+            const int32_t count = (int32_t)program.opcodes.size();
+            int32_t k = 0;
+            for(int32_t loop = 0; loop < program.loopCount(); loop++){
+                run<false>(k, program.loopBegin[loop]);
+                for(int sweep = 0; sweep < LOOP_SWEEP_LIMIT && run<true>(program.loopBegin[loop], program.loopEnd[loop]); sweep++){}
+                k = program.loopEnd[loop];
+            }
+            run<false>(k, count);
+        }
+
+        // @brief
+        // runs every combination of the inputs, onBlock(first, lanes) is called once per word
+        // lane j of the block is input pattern first + j (bit k of the pattern is input k)
+        // lanes is how many of the lanes are valid, the last block can be partial
+        // every lane starts from all nets low, so a latch settles the same whichever block it is in
+        // returns false and runs nothing with more than EXHAUSTIVE_MAX_INPUTS inputs
+        template<typename Fn>
+        bool exhaustive(Fn&& onBlock){
+            const int n = inputCount();
+            if(n > EXHAUSTIVE_MAX_INPUTS) return false;
+            const int lowBits = n < Lanes<Word>::LOG2 ? n : Lanes<Word>::LOG2;
+            const uint64_t total = 1ull << n;
+            const uint64_t blocks = total >> lowBits;
+            const int lanes = 1 << lowBits;
+
+            //the low inputs vary inside a word and never change
+            for(int k = 0; k < lowBits; k++){
+                setInput(k, Lanes<Word>::pattern(k));
+            }
+            for(uint64_t b = 0; b < blocks; b++){
+                //the high inputs are constant across a word, they count the blocks
+                for(int k = lowBits; k < n; k++){
+                    setInput(k, Lanes<Word>::broadcast((b >> (k - lowBits)) & 1));
+                }
+                //a latch would keep what another pattern left in its lane, every block starts its loops low
+                clearLoops();
+                evaluate();
+                onBlock(b << lowBits, lanes);
+            }
+            return true;
+        }
+
+    private:
+        const Program program;
+        std::vector<Word> nets;
+
+        void clearLoops(){
+            for(int32_t loop = 0; loop < program.loopCount(); loop++){
+                for(int32_t k = program.loopBegin[loop]; k < program.loopEnd[loop]; k++){
+                    nets[program.target[k]] = Lanes<Word>::broadcast(false);
+                }
+            }
+        }
+
+        // @brief
+        // evaluates slots [begin, end) in order, returns true if any lane of any net changed
+        // only loops need to know, the acyclic slots skip the comparison
+        template<bool TRACK>
+        bool run(int32_t begin, int32_t end){
+            const Word ones = Lanes<Word>::broadcast(true);
+            Word* v = nets.data();
+            bool changed = false;
+            for(int32_t k = begin; k < end; k++){
+                Word value = program.opcodes[k] == OP_REDUCE
+                           ? reduceOp<Word>((uint8_t)program.operandC[k], v, &program.fanin[program.operandA[k]],
+                                            program.operandB[k], ones)
+                           : applyOp<Word>(program.opcodes[k], v[program.operandA[k]], v[program.operandB[k]],
+                                           v[program.operandC[k]], ones);
+                if(TRACK && !changed) changed = value != v[program.target[k]];
+                v[program.target[k]] = value;
+            }
+            return changed;
+        }
+};
+#endif // BATCH_SIMULATOR_HPP
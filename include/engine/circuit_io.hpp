@@ -0,0 +1,44 @@
+#ifndef CIRCUIT_IO_HPP
+#define CIRCUIT_IO_HPP
+#include <netlist.hpp>
+#include <cstdint>
+#include <string>
+
+// @brief
+// writes the netlist as circuit.json (array of {id, type, x, y, width, in1/in2/sel or src})
+// the ports of an n-input gate past the second are in3, in4, ...
+// width is only written for buses, a record without it is a single bit
+// records are streamed straight to the file, compact drops the indentation
+// and the spaces but still writes one record per line
+bool saveCircuitJson(const Netlist& netlist, const std::string& filename, bool compact = false);
+
+// @brief
+// replaces the netlist with the content of a circuit.json file
+// returns false if the file can't be opened or parsed, a width is outside 1..MAX_WIDTH or a
+// width, port or position is not a number that fits, the netlist is untouched then
+bool loadCircuitJson(Netlist& netlist, const std::string& filename);
+
+// @brief
+// version of the binary format written by saveCircuitBinary, readers reject newer files
+// 2 stores the bus width of every node, 3 lets n-input gates have more inputs than their type's default
+constexpr uint16_t CIRCUIT_BINARY_VERSION = 3;
+
+// @brief
+// writes the netlist in the binary format (.dsim), little endian:
+//   header  magic "DSIM", version, header size, node/input counts, section offsets
+//   nodes   one fixed 16 byte record per node {type, input count, width, x, y, first input}
+//   inputs  one int32 per input port, the source node or -1
+bool saveCircuitBinary(const Netlist& netlist, const std::string& filename);
+
+// @brief
+// replaces the netlist with the content of a binary circuit file
+// the file is memory mapped and the records are copied straight into the netlist, nothing is parsed
+// a width past MAX_WIDTH fails the load like a bad header does
+bool loadCircuitBinary(Netlist& netlist, const std::string& filename);
+
+// @brief
+// binary for .dsim files, json for everything else
+bool saveCircuitFile(const Netlist& netlist, const std::string& filename, bool compact = false);
+bool loadCircuitFile(Netlist& netlist, const std::string& filename);
+
+#endif // CIRCUIT_IO_HPP
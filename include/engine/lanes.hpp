@@ -0,0 +1,90 @@
+#ifndef LANES_HPP
+#define LANES_HPP
+#include <cstdint>
+
+// @brief
+// a multi-word bit vector, one simulation lane per bit
+// the loops are fixed-size, so the compiler turns them into AVX2/AVX-512 ops when the target allows it
+template<int WORDS>
+struct WideWord{
+    alignas(WORDS * 8 >= 64 ? 64 : WORDS * 8) uint64_t w[WORDS];
+
+    friend WideWord operator&(const WideWord& a, const WideWord& b){
+        WideWord r;
+        for(int i = 0; i < WORDS; i++) r.w[i] = a.w[i] & b.w[i];
+        return r;
+    }
+    friend WideWord operator|(const WideWord& a, const WideWord& b){
+        WideWord r;
+        for(int i = 0; i < WORDS; i++) r.w[i] = a.w[i] | b.w[i];
+        return r;
+    }
+    friend WideWord operator^(const WideWord& a, const WideWord& b){
+        WideWord r;
+        for(int i = 0; i < WORDS; i++) r.w[i] = a.w[i] ^ b.w[i];
+        return r;
+    }
+    friend bool operator!=(const WideWord& a, const WideWord& b){
+        uint64_t diff = 0;
+        for(int i = 0; i < WORDS; i++) diff |= a.w[i] ^ b.w[i];
+        return diff != 0;
+    }
+};
+
+using Lanes64  = uint64_t;
+using Lanes256 = WideWord<4>;
+using Lanes512 = WideWord<8>;
+
+// @brief
+// lane helpers for every word type the batch engine accepts
+template<typename Word>
+struct Lanes;
+
+template<>
+struct Lanes<uint64_t>{
+    static constexpr int COUNT = 64;
+    static constexpr int LOG2 = 6;
+
+    static uint64_t broadcast(bool v){
+        return v ? ~0ull : 0ull;
+    }
+    static bool get(uint64_t word, int lane){
+        return (word >> lane) & 1;
+    }
+    // @brief
+    // word whose lane j holds bit k of j, k < LOG2
+    // with one of these per input, the lanes enumerate every input combination
+    static uint64_t pattern(int k){
+        static const uint64_t patterns[6] = {
+            0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+            0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+        };
+        return patterns[k];
+    }
+};
+
+template<int WORDS>
+struct Lanes<WideWord<WORDS>>{
+    static constexpr int COUNT = 64 * WORDS;
+    static constexpr int LOG2 = 6 + (WORDS >= 2) + (WORDS >= 4) + (WORDS >= 8) + (WORDS >= 16);
+    static_assert((WORDS & (WORDS - 1)) == 0, "WideWord size must be a power of two");
+
+    static WideWord<WORDS> broadcast(bool v){
+        WideWord<WORDS> r;
+        for(int i = 0; i < WORDS; i++) r.w[i] = Lanes<uint64_t>::broadcast(v);
+        return r;
+    }
+    static bool get(const WideWord<WORDS>& word, int lane){
+        return (word.w[lane >> 6] >> (lane & 63)) & 1;
+    }
+    static WideWord<WORDS> pattern(int k){
+        WideWord<WORDS> r;
+        for(int i = 0; i < WORDS; i++){
+            //the low 6 bits of the lane index live inside a word, the rest pick the word
+            r.w[i] = k < 6 ? Lanes<uint64_t>::pattern(k) : Lanes<uint64_t>::broadcast((i >> (k - 6)) & 1);
+        }
+        return r;
+    }
+};
+
+#endif // LANES_HPP
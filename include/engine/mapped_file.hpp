@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// @brief
+// read-only memory mapping of a whole file, the pages are loaded by the os on first touch
+// so reading the file costs no copy into a buffer
+class MappedFile{
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // @brief
+        // maps the file, returns false if it can't be opened (an empty file maps to size 0)
+        bool open(const std::string& filename);
+        void close();
+
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const uint8_t* bytes = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#else
+        int fd = -1;
+#endif
+};
+#endif // MAPPED_FILE_HPP
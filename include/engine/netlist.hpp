@@ -0,0 +1,203 @@
+#ifndef NETLIST_HPP
+#define NETLIST_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// @brief
+// kinds of nodes in the netlist, the names are what circuit files store
+enum GateType : uint8_t{
+    GATE_SWITCH,
+    GATE_LIGHT,
+    GATE_AND,
+    GATE_OR,
+    GATE_NOT,
+    GATE_XOR,
+    GATE_ADD,
+    GATE_MUX,
+    GATE_EQ,
+    GATE_LT,
+    GATE_NAND,
+    GATE_NOR,
+    GATE_XNOR,
+    GATE_DFF,     //loads d on a rising edge of clk
+    GATE_REG,     //loads d on a rising edge of clk while en is high (or open)
+    GATE_COUNTER, //counts up on a rising edge of clk while en is high (or open), reset wins
+    GATE_CLOCK,   //a source the simulator toggles once per half cycle
+    GATE_TYPE_COUNT,
+    GATE_NONE = 0xFF //removed node, its index waits on the free list
+};
+
+//most ports a gate type names, the ports past them are "in3", "in4", ... of an n-input gate
+constexpr int MAX_INPUTS = 3;
+
+//most inputs of an n-input gate (AND, OR, XOR and their inverses)
+constexpr int MAX_FANIN = 64;
+
+//every node carries a bus of 1 to MAX_WIDTH bits, one machine word per net
+constexpr int MAX_WIDTH = 64;
+
+// @brief
+// the bits of a bus of that width set
+inline uint64_t widthMask(int width){
+    return width >= 64 ? ~0ull : (1ull << width) - 1;
+}
+
+// @brief
+// everything that differs between gate types as data, so the editor, the files and the
+// simulator handle every type the same way instead of branching on it
+// every type works on buses, a node's width applies to its ports except for the one bit ones
+struct GateInfo{
+    const char* name;                 //what circuit files store ("AND", "SWITCH", ...)
+    uint8_t inputs;                   //number of input ports a new node gets
+    bool variadic;                    //the node can have 2 to MAX_FANIN inputs instead
+    bool output;                      //lights only read
+    bool bitOutput;                   //the output is one bit whatever the width (compares)
+    bool sequential;                  //holds its value between clock edges instead of following its inputs
+    uint8_t bitPorts;                 //mask of the inputs that are always one bit (mux select, clocks)
+    const char* portKeys[MAX_INPUTS]; //json keys of the input ports
+};
+
+// @brief
+// the row of a gate type, GATE_NONE and unknown values get an empty row
+const GateInfo& gateInfo(GateType type);
+
+// @brief
+// input port stored under a json key by any gate type ("inN" is port N - 1), -1 if no type uses it
+int gatePortFromKey(const std::string& key);
+
+// @brief
+// json key of an input port of a gate type, the named one or "inN" past them
+std::string gatePortKey(GateType type, int port);
+
+// @brief
+// name used in circuit files ("AND", "SWITCH", ...)
+const char* gateTypeName(GateType type);
+
+// @brief
+// reverse of gateTypeName, returns false for unknown names
+bool gateTypeFromName(const std::string& name, GateType& type);
+
+// @brief
+// number of input ports a new node of the type gets
+int gateInputCount(GateType type);
+
+// @brief
+// reference to a node that notices when the node is removed
+// every add draws a new generation from one counter shared by all netlists, so a handle taken
+// before a remove, a clear() or a load never resolves to whatever reuses the index later
+struct NodeHandle{
+    int32_t node = -1;
+    uint32_t generation = 0;
+};
+
+// @brief
+// the circuit without any rendering, what the simulator compiles and the files store
+// nodes are indices, every property is its own contiguous array (struct of arrays)
+// so the simulation data stays dense and the layout data never pollutes its cache lines
+// the input ports of a node are a range of slots in one shared array, as many as it has
+class Netlist{
+    public:
+        // @brief
+        // new node, it takes the most recently removed index if there is one
+        // ports only matters for n-input gates, 0 gives the type's default
+        int add(GateType type, float x, float y, int width = 1, int ports = 0);
+
+        // @brief
+        // wires source's output into a port of node, source -1 opens the port
+        // returns false if the port doesn't exist or the widths of the two ends differ
+        bool connect(int node, int port, int source);
+
+        // @brief
+        // changes the bus width of a node, returns false and leaves it alone outside 1..MAX_WIDTH
+        // the wires on either side that no longer match are opened, the value is cut to the width
+        bool setWidth(int node, int width);
+
+        // @brief
+        // changes the number of inputs of an n-input gate (clamped to 2..MAX_FANIN)
+        // the ports that go away are opened, returns false for the other types
+        bool setInputCount(int node, int count);
+
+        // @brief
+        // disconnects every reader of the node and leaves a GATE_NONE hole in its place
+        // the hole is reused by the next add(), only the node's own wires are visited, O(fanin + fanout)
+        void remove(int node);
+
+        // @brief
+        // drops every node, the arrays keep their memory, so this is O(1) for the plain data
+        void clear();
+
+        // @brief
+        // preallocates every array for the given number of nodes, loaders call it before add()
+        // the input slots are guessed at two per node unless the count is known
+        void reserve(int nodes);
+        void reserve(int nodes, size_t slots);
+
+        int size() const { return (int)types.size(); }
+        bool isAlive(int node) const { return types[node] != GATE_NONE; }
+        GateType type(int node) const { return (GateType)types[node]; }
+        int inputCount(int node) const { return inputCounts[node]; }
+        int32_t input(int node, int port) const { return inputs[inputStart[node] + port]; }
+        bool state(int node) const { return values[node] != 0; }
+        void setState(int node, bool value) { values[node] = value ? 1 : 0; }
+        uint64_t value(int node) const { return values[node]; }
+        void setValue(int node, uint64_t value) { values[node] = value & widthMask(outputWidth(node)); }
+
+        int width(int node) const { return widths[node]; }
+        int outputWidth(int node) const { return gateInfo(type(node)).bitOutput ? 1 : widths[node]; }
+        int inputWidth(int node, int port) const {
+            return port < 8 && ((gateInfo(type(node)).bitPorts >> port) & 1) ? 1 : widths[node];
+        }
+
+        NodeHandle handle(int node) const { return {node, generations[node]}; }
+
+        // @brief
+        // node of the handle, -1 if it was removed (or the netlist was cleared) since
+        int resolve(NodeHandle h) const {
+            if (h.node < 0 || h.node >= size() || h.generation == 0 || generations[h.node] != h.generation)
+                return -1;
+            return h.node;
+        }
+
+        float x(int node) const { return posX[node]; }
+        float y(int node) const { return posY[node]; }
+        void setPosition(int node, float x, float y) { posX[node] = x; posY[node] = y; }
+
+        // @brief
+        // calls fn(reader, port) for every input port wired to the node
+        template<typename Fn>
+        void forEachReader(int node, Fn&& fn) const {
+            for (int32_t slot = readerHead[node]; slot >= 0; slot = nextReader[slot])
+                fn(slotNode[slot], slot - inputStart[slotNode[slot]]);
+        }
+
+    private:
+        //simulation data
+        std::vector<uint8_t> types;
+        std::vector<int32_t> inputStart;    //first input slot of every node
+        std::vector<uint8_t> inputCounts;   //ports in use, 0 while the node is removed
+        std::vector<uint8_t> inputCapacity; //slots reserved at inputStart, a node grows into them
+        std::vector<int32_t> inputs;        //per slot, the source node, -1 when open
+        std::vector<int32_t> slotNode;      //per slot, its node, -1 once a node moved to a bigger range
+        std::vector<uint64_t> values; //current output, switches keep their position through it
+        std::vector<uint8_t> widths;  //bus width of every node, 1 for single bits
+
+        //reverse index: the input slots reading a node form a doubly linked list
+        std::vector<int32_t> readerHead; //first slot reading the node, -1 if none
+        std::vector<int32_t> nextReader; //per input slot
+        std::vector<int32_t> prevReader; //per input slot
+
+        void link(int32_t slot, int32_t source);
+        void unlink(int32_t slot);
+        void allocateInputs(int node, int count);
+        int clampInputs(GateType type, int count) const;
+
+        //node recycling
+        std::vector<uint32_t> generations; //0 while the node is removed
+        std::vector<int32_t> freeNodes;    //removed indices, reused last in first out
+
+        //layout data, only the editor and the files use it
+        std::vector<float> posX;
+        std::vector<float> posY;
+};
+#endif // NETLIST_HPP
@@ -0,0 +1,60 @@
+#ifndef SIM_CLOCK_HPP
+#define SIM_CLOCK_HPP
+#include <cstdint>
+#include <limits>
+
+// @brief
+// fixed rate clock of the simulation, independent of how often frames are drawn
+// it turns elapsed wall time into a number of simulation ticks (one step() each)
+// a rate of 0 means as fast as possible, the caller bounds the work by time instead
+class SimClock{
+    public:
+        explicit SimClock(double ticksPerSecond = 60.0) : rate(ticksPerSecond) {}
+
+        void setRate(double ticksPerSecond){
+            rate = ticksPerSecond > 0 ? ticksPerSecond : 0;
+            accumulated = 0;
+        }
+        double getRate() const { return rate; }
+        bool unlimited() const { return rate <= 0; }
+
+        // @brief
+        // moves the clock to now (nanoseconds) and returns how many ticks are due
+        // a late caller gets at most MAX_BACKLOG seconds of ticks, the rest is dropped
+        int64_t advance(uint64_t nowNs){
+            uint64_t elapsed = started ? nowNs - lastNs : 0;
+            started = true;
+            lastNs = nowNs;
+            if (unlimited())
+                return std::numeric_limits<int64_t>::max();
+
+            accumulated += (double)elapsed * rate / 1e9;
+            if (accumulated > rate * MAX_BACKLOG) accumulated = rate * MAX_BACKLOG;
+            int64_t due = (int64_t)accumulated;
+            accumulated -= (double)due;
+            return due;
+        }
+
+        // @brief
+        // the simulation has nothing to do, ticks are not banked while it waits
+        // the next tick is ready at once so an edit is shown without waiting a period
+        void idle(){
+            accumulated = 1.0;
+            started = false; //the time spent idle doesn't count
+        }
+
+        // @brief
+        // time until the next tick is due, 0 if unlimited or already due
+        uint64_t nsUntilNextTick() const {
+            if (unlimited() || accumulated >= 1.0) return 0;
+            return (uint64_t)((1.0 - accumulated) / rate * 1e9);
+        }
+
+    private:
+        static constexpr double MAX_BACKLOG = 0.25;
+        double rate;
+        double accumulated = 0; //fraction of a tick carried to the next advance()
+        uint64_t lastNs = 0;
+        bool started = false;
+};
+#endif // SIM_CLOCK_HPP
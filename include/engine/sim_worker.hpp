@@ -0,0 +1,133 @@
+#ifndef SIM_WORKER_HPP
+#define SIM_WORKER_HPP
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <netlist.hpp>
+#include <simulator.hpp>
+#include <sim_clock.hpp>
+#include <spsc_queue.hpp>
+#include <triple_buffer.hpp>
+
+// @brief
+// node outputs as the simulation thread last published them, one bit per node
+// the few nodes with a bus output also get their whole word, sorted by node
+struct SimSnapshot{
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> unstable; //nodes on a loop that is oscillating, same layout as bits
+    std::vector<int32_t> busNodes;
+    std::vector<uint64_t> busValues;
+    int nodeCount = 0;
+    int oscillatingLoops = 0;
+    uint64_t tick = 0;    //simulation ticks run so far
+    bool settled = true;  //nothing was pending and no clock was ticking when it was taken
+
+    bool state(int node) const {
+        return node >= 0 && node < nodeCount && ((bits[node >> 6] >> (node & 63)) & 1);
+    }
+    bool oscillating(int node) const {
+        return oscillatingLoops > 0 && node >= 0 && node < nodeCount && ((unstable[node >> 6] >> (node & 63)) & 1);
+    }
+    // @brief
+    // full output of a node, the bit of state() for single bit nodes
+    uint64_t value(int node) const {
+        auto it = std::lower_bound(busNodes.begin(), busNodes.end(), node);
+        if (it != busNodes.end() && *it == node) return busValues[it - busNodes.begin()];
+        return state(node) ? 1 : 0;
+    }
+};
+
+// @brief
+// runs the simulation on its own thread
+// the worker owns a copy of the netlist topology, the owner thread sends it the same edits it
+// makes to its own netlist through a lock-free queue, so node ids match on both sides
+// results come back as snapshots through a triple buffer, the reader never blocks the worker
+// the only lock parks the worker while it has nothing to do
+class SimWorker{
+    public:
+        SimWorker();
+        ~SimWorker();
+
+        // @brief
+        // called on the worker thread after every published snapshot (e.g. to wake the ui)
+        // set it before start()
+        void setPublishCallback(std::function<void()> fn) { onPublish = std::move(fn); }
+
+        void start();
+        void stop();
+
+        //edits, owner thread only, applied by the worker in the order they were sent
+        void add(GateType type);
+        void remove(int node);
+        void connect(int node, int port, int source);
+        void setSwitch(int node, uint64_t value);
+        void setWidth(int node, int width);
+        void setInputCount(int node, int count);
+        void setTickRate(double ticksPerSecond);
+        // @brief
+        // replaces the whole circuit with a copy of the netlist, states included
+        void load(const Netlist& netlist);
+
+        // @brief
+        // reader side: takes the latest snapshot, returns false if nothing new was published
+        bool acquire() { return snapshots.acquire(); }
+        const SimSnapshot& snapshot() const { return snapshots.front(); }
+
+    private:
+        enum CommandKind : uint8_t{
+            CMD_ADD,
+            CMD_REMOVE,
+            CMD_CONNECT,
+            CMD_SET_SWITCH,
+            CMD_SET_WIDTH,
+            CMD_SET_INPUTS,
+            CMD_SET_RATE,
+            CMD_LOAD
+        };
+
+        struct Command{
+            CommandKind kind;
+            GateType type;
+            uint64_t value;
+            int node;
+            int port;             //CMD_CONNECT, the width or input count for CMD_SET_WIDTH/CMD_SET_INPUTS
+            int source;
+            double rate;
+            Netlist* netlist; //CMD_LOAD, the worker takes ownership
+        };
+
+        void post(const Command& command);
+        void run();
+        void apply(const Command& command);
+        void setBit(int node, bool value);
+        void recompile();
+        void storeChanged(); //copies the nets the simulator changed into the netlist and the bits
+        void publish();
+        void park(uint64_t timeoutNs);
+
+        SpscQueue<Command> commands;
+        TripleBuffer<SimSnapshot> snapshots;
+        std::function<void()> onPublish;
+
+        std::thread thread;
+        std::atomic<bool> running{false};
+        std::mutex parkMutex;
+        std::condition_variable parkSignal;
+        std::atomic<bool> parked{false};
+
+        //worker thread only
+        Netlist netlist;
+        Simulator simulator;
+        SimClock clock;
+        std::vector<uint64_t> bits; //node states, copied into every snapshot
+        std::vector<int32_t> busNodes; //nodes with a bus output, found at every compile
+        bool dirty = true;          //recompile before the next tick
+        bool unpublished = true;
+        uint64_t ticks = 0;
+};
+#endif // SIM_WORKER_HPP
@@ -0,0 +1,297 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <netlist.hpp>
+#include <thread_pool.hpp>
+
+//levels narrower than this are evaluated by one thread, waking the pool would cost more
+constexpr int32_t PARALLEL_MIN_WIDTH = 4096;
+
+//most passes over a combinational loop before it is given up on as oscillating
+//a latch settles in two or three, the gates of a loop are ordered along its wires
+constexpr int LOOP_SWEEP_LIMIT = 64;
+
+//most times the registers are latched after one clock edge, a register clocked by another
+//register's output (a ripple counter) only sees its edge in the round after
+constexpr int LATCH_ROUND_LIMIT = 64;
+
+// @brief
+// instructions of the compiled program, one per gate
+enum Opcode : uint8_t{
+    OP_SOURCE, //switch, its value is driven from outside
+    OP_BUF,    //light, copies its source
+    OP_NOT,
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_ADD,    //wraps around at the width
+    OP_MUX,    //a when c is low, b when it is high
+    OP_EQ,     //one bit
+    OP_LT,     //one bit, unsigned
+    OP_NAND,
+    OP_NOR,
+    OP_XNOR,
+    OP_REDUCE, //n-input gate, its operands are a range of Program::fanin (see there)
+    //sequential elements, they are not slots of the program but entries of its register list
+    OP_DFF,
+    OP_REG,
+    OP_COUNTER
+};
+
+// @brief
+// the logic of every opcode on one-bit nets, for the bit-parallel engine
+// Word is one value per bit lane, ones has every lane set
+template<typename Word>
+inline Word applyOp(uint8_t op, Word a, Word b, Word c, Word ones){
+    switch(op){
+        case OP_NOT: return a ^ ones;
+        case OP_AND: return a & b;
+        case OP_OR:  return a | b;
+        case OP_XOR:
+        case OP_ADD: return a ^ b; //a one-bit sum drops the carry
+        case OP_MUX: return (a & (c ^ ones)) | (b & c);
+        case OP_EQ:  return a ^ b ^ ones;
+        case OP_LT:  return (a ^ ones) & b;
+        case OP_NAND: return (a & b) ^ ones;
+        case OP_NOR:  return (a | b) ^ ones;
+        case OP_XNOR: return a ^ b ^ ones;
+        default:     return a;
+    }
+}
+
+// @brief
+// the logic of every opcode on whole buses, one machine instruction or two per gate
+// the operands are already cut to their width, mask has the bits of the output's width
+inline uint64_t applyWordOp(uint8_t op, uint64_t a, uint64_t b, uint64_t c, uint64_t mask){
+    switch(op){
+        case OP_NOT: return ~a & mask;
+        case OP_AND: return a & b;
+        case OP_OR:  return a | b;
+        case OP_XOR: return a ^ b;
+        case OP_ADD: return (a + b) & mask;
+        case OP_MUX: return c ? b : a;
+        case OP_EQ:  return a == b;
+        case OP_LT:  return a < b;
+        case OP_NAND: return (a & b) ^ mask;
+        case OP_NOR:  return (a | b) ^ mask;
+        case OP_XNOR: return a ^ b ^ mask;
+        default:     return a;
+    }
+}
+
+// @brief
+// an n-input gate: op (OP_AND to OP_XNOR, the two-input one) folded over the nets in[0..count)
+// ones is every lane (bit-parallel engine) or the width mask (word engine), the inverting
+// ops flip the result once at the end
+// four accumulators so the loads of the inputs don't wait on each other, with a Word of
+// several machine words each step is a vector instruction over all of its lanes
+template<typename Word>
+inline Word reduceOp(uint8_t op, const Word* v, const int32_t* in, int32_t count, Word ones){
+    bool inverted = true;
+    uint8_t base = op;
+    switch(op){
+        case OP_NAND: base = OP_AND; break;
+        case OP_NOR: base = OP_OR; break;
+        case OP_XNOR: base = OP_XOR; break;
+        default: inverted = false; break;
+    }
+    //and/or don't mind seeing an input twice, every accumulator starts from the first two
+    Word acc[4] = {v[in[0]], v[in[1]], v[in[0]], v[in[1]]};
+    int32_t k = 2;
+    switch(base){
+        case OP_AND:
+            for(; k + 4 <= count; k += 4){
+                acc[0] = acc[0] & v[in[k]];
+                acc[1] = acc[1] & v[in[k + 1]];
+                acc[2] = acc[2] & v[in[k + 2]];
+                acc[3] = acc[3] & v[in[k + 3]];
+            }
+            for(; k < count; k++) acc[0] = acc[0] & v[in[k]];
+            acc[0] = acc[0] & acc[1] & acc[2] & acc[3];
+            break;
+        case OP_OR:
+            for(; k + 4 <= count; k += 4){
+                acc[0] = acc[0] | v[in[k]];
+                acc[1] = acc[1] | v[in[k + 1]];
+                acc[2] = acc[2] | v[in[k + 2]];
+                acc[3] = acc[3] | v[in[k + 3]];
+            }
+            for(; k < count; k++) acc[0] = acc[0] | v[in[k]];
+            acc[0] = acc[0] | acc[1] | acc[2] | acc[3];
+            break;
+        default: //xor would cancel the copies, its extra accumulators start from zero
+            acc[2] = acc[3] = ones ^ ones;
+            for(; k + 4 <= count; k += 4){
+                acc[0] = acc[0] ^ v[in[k]];
+                acc[1] = acc[1] ^ v[in[k + 1]];
+                acc[2] = acc[2] ^ v[in[k + 2]];
+                acc[3] = acc[3] ^ v[in[k + 3]];
+            }
+            for(; k < count; k++) acc[0] = acc[0] ^ v[in[k]];
+            acc[0] = acc[0] ^ acc[1] ^ acc[2] ^ acc[3];
+            break;
+    }
+    return inverted ? acc[0] ^ ones : acc[0];
+}
+
+// @brief
+// the compiled netlist: a flat opcode/operand array sorted by logic level
+// net i is the output of node i, a bus of up to 64 bits held in one word, net netCount is the constant low net open inputs read
+// combinational loops (strongly connected gates) are condensed into one level each and
+// sit at the end of it, their slots are contiguous so they can be iterated on their own
+// gates with more than two inputs are OP_REDUCE: operandA is the first of their nets in fanin,
+// operandB how many there are and operandC the two-input opcode that is folded over them
+struct Program{
+    std::vector<uint8_t> opcodes;
+    std::vector<int32_t> operandA;
+    std::vector<int32_t> operandB;
+    std::vector<int32_t> operandC; //mux select
+    std::vector<int32_t> fanin;    //input nets of the OP_REDUCE slots, one range each
+    std::vector<int32_t> target;
+    std::vector<int32_t> slotLevel;
+    std::vector<int32_t> levelStart; //slots of level l are [levelStart[l], levelStart[l + 1])
+
+    std::vector<int32_t> loopBegin; //slots of loop k are [loopBegin[k], loopEnd[k]), in level order
+    std::vector<int32_t> loopEnd;
+    std::vector<int32_t> slotLoop;  //loop of every slot, -1 for the acyclic gates
+
+    std::vector<int32_t> sources; //nets driven by switches, in node order
+    std::vector<int32_t> probes;  //nets of the lights, in node order
+    std::vector<int32_t> clocks;  //nets of the clock sources, in node order
+
+    //flip-flops, registers and counters: their outputs are sources to the levelized logic,
+    //so a loop through one isn't combinational, step() loads them on a rising clock edge
+    std::vector<int32_t> registers;      //their nets, in node order
+    std::vector<uint8_t> registerOp;     //OP_DFF, OP_REG or OP_COUNTER
+    std::vector<int32_t> registerData;   //d, the reset of a counter
+    std::vector<int32_t> registerClock;
+    std::vector<int32_t> registerEnable; //-1 when open, the element is always enabled
+
+    std::vector<uint64_t> netMask; //bits of every net's width
+    int32_t netCount = 0;
+    int32_t numLevels = 0;
+    bool wide = false; //some net is wider than one bit, the bit-parallel engine can't run it
+
+    int32_t loopCount() const { return (int32_t)loopBegin.size(); }
+    int32_t widestLevel() const {
+        int32_t widest = 0;
+        for (int32_t l = 0; l < numLevels; l++)
+            if (levelStart[l + 1] - levelStart[l] > widest) widest = levelStart[l + 1] - levelStart[l];
+        return widest;
+    }
+    // @brief
+    // true if the circuit keeps state between steps, the bit-parallel engine can't run it
+    bool sequential() const { return !registers.empty() || !clocks.empty(); }
+};
+
+// @brief
+// levelized compiled simulation engine
+// compile() sorts the netlist by logic level once (after an edit) and stores it as a flat
+// opcode/operand array, so a single evaluate() pass settles the whole combinational network
+// settle() is the event-driven version: only gates whose inputs flipped are recomputed
+// a loop is swept in slot order until it stops changing, so latches built from gates settle
+// the same way every time, one that never does is flagged oscillating after LOOP_SWEEP_LIMIT
+class Simulator{
+    public:
+        // @brief
+        // rebuilds the program from the netlist, call it after every edit
+        // the nets start from the node states, so an edit doesn't reset the circuit
+        // a circuit with registers is settled right away, getChanged() has the nets that moved
+        void compile(const Netlist& netlist);
+
+        // @brief
+        // runs the whole program once
+        void evaluate();
+
+        // @brief
+        // drives a switch net, only its readers get scheduled and only if the value changed
+        // the value is cut to the width of the net
+        void setSource(int net, uint64_t value);
+
+        // @brief
+        // evaluates the scheduled gates level by level
+        // returns true if any net changed, an idle circuit costs nothing
+        bool settle();
+
+        // @brief
+        // one clock cycle in two phases: the clock sources go high and the logic settles, then
+        // every register whose clock input rose samples its inputs and all of them load at once,
+        // then their outputs settle in turn, and the same again for the clocks going low
+        // without clock sources it is one settle and latch, so a switch can clock a flip-flop
+        // returns true if any net changed, getChanged() has every net that did
+        bool step();
+
+        bool value(int net) const { return nets[net] != 0; }
+        uint64_t word(int net) const { return nets[net]; }
+
+        // @brief
+        // nets whose value changed during the last settle() or evaluate()
+        const std::vector<int32_t>& getChanged() const { return changed; }
+
+        bool hasPending() const { return lowestPending < program.numLevels; }
+
+        // @brief
+        // true while steps still have work: something is pending, a net a register samples
+        // changed since the last step (a switch on a clock input), or a clock keeps ticking
+        bool isRunning() const { return hasPending() || latchPending || !program.clocks.empty(); }
+
+        // @brief
+        // loops that didn't reach a fixed point the last time they were swept
+        int oscillatingCount() const { return oscillatingLoops; }
+        bool isOscillating(int loop) const { return oscillating[loop] != 0; }
+
+        // @brief
+        // evaluates wide levels on this many threads (the caller included), 1 = single threaded
+        // the gates of one level never read each other, so a level splits into independent chunks
+        void setThreadCount(int threads);
+        int threadCount() const { return pool ? pool->size() : 1; }
+
+        int gateCount() const { return (int)program.opcodes.size(); }
+        int levelCount() const { return program.numLevels; }
+        int loopCount() const { return program.loopCount(); }
+        int registerCount() const { return (int)program.registers.size(); }
+        const Program& getProgram() const { return program; }
+
+    private:
+        Program program;
+
+        //readers of every net, as program slots (CSR)
+        std::vector<int32_t> fanoutStart;
+        std::vector<int32_t> fanout;
+
+        //event queue, one bucket per level so every gate runs after its inputs
+        std::vector<std::vector<int32_t>> pending;
+        std::vector<int32_t> processing;
+        std::vector<uint8_t> queued;
+        int lowestPending = 0;
+
+        std::vector<uint64_t> nets; //one word per net, only the bits of its width are used
+        std::vector<int32_t> changed;
+
+        std::vector<uint8_t> lastClock; //per register, the clock input it saw at the last latch
+        std::vector<uint8_t> feedsRegister; //per net, some register samples it
+        bool latchPending = false;      //such a net changed, the next step() has to latch
+        std::vector<std::pair<int32_t, uint64_t>> latched; //next values of the registers that load
+
+        std::vector<uint8_t> oscillating; //per loop
+        int oscillatingLoops = 0;
+        std::vector<uint64_t> loopEntry;  //values of a loop's nets before it is swept
+
+        std::unique_ptr<ThreadPool> pool;
+        std::vector<std::vector<int32_t>> workerChanged; //changed nets of each pool participant
+
+        void propagate();
+        bool latch();
+        void noteRegisterInputs();
+        void schedule(int32_t slot);
+        void scheduleReaders(int32_t net);
+        uint64_t compute(int32_t slot) const;
+        void evaluateSlots(int32_t begin, int32_t end, std::vector<int32_t>& out);
+        void solveLoop(int32_t loop, std::vector<int32_t>& out);
+        bool runParallel(int32_t width) const;
+        int32_t chunkSize(int32_t width) const;
+};
+#endif // SIMULATOR_HPP
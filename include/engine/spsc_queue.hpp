@@ -0,0 +1,55 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// @brief
+// bounded lock-free queue for exactly one producer thread and one consumer thread
+// head and tail only ever grow, their difference is the fill level
+// each side owns one index and reads the other's with acquire, so no locks or cas are needed
+template<typename T>
+class SpscQueue{
+    public:
+        // capacity is rounded up to a power of two so positions wrap with a mask
+        explicit SpscQueue(size_t capacity){
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            slots.resize(size);
+            mask = size - 1;
+        }
+
+        // @brief
+        // producer side, returns false if the queue is full
+        bool push(const T& value){
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask)
+                return false;
+            slots[t & mask] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // @brief
+        // consumer side, returns false if the queue is empty
+        bool pop(T& value){
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return false;
+            value = slots[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::vector<T> slots;
+        size_t mask;
+        //on their own cache lines, the two threads write one each
+        alignas(64) std::atomic<size_t> head{0}; //next slot to pop, written by the consumer
+        alignas(64) std::atomic<size_t> tail{0}; //next slot to push, written by the producer
+};
+#endif // SPSC_QUEUE_HPP
@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// @brief
+// fixed set of threads for data-parallel loops
+// parallelFor() cuts a range into chunks that the threads claim with an atomic counter, so a
+// thread that finishes early takes more chunks instead of idling (dynamic load balancing)
+// the calling thread works too, and it returns once the whole range is done
+class ThreadPool{
+    public:
+        // @brief
+        // threads is the total number of participants, the caller included
+        explicit ThreadPool(int threads);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        int size() const { return (int)workers.size() + 1; }
+
+        // @brief
+        // calls fn(begin, end, participant) for chunks of [0, count), participant is in [0, size())
+        template<typename Fn>
+        void parallelFor(int32_t count, int32_t chunk, Fn&& fn){
+            auto invoke = [](void* context, int32_t begin, int32_t end, int participant){
+                (*(Fn*)context)(begin, end, participant);
+            };
+            dispatch(count, chunk, invoke, (void*)&fn);
+        }
+
+    private:
+        using Invoke = void (*)(void*, int32_t, int32_t, int);
+
+        void dispatch(int32_t count, int32_t chunk, Invoke invoke, void* context);
+        void runChunks(int participant);
+        void workerLoop(int participant);
+
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        //the current job, written by the caller before generation is bumped
+        Invoke jobInvoke = nullptr;
+        void* jobContext = nullptr;
+        int32_t jobCount = 0;
+        int32_t jobChunk = 1;
+        std::atomic<int32_t> nextChunk{0};
+        std::atomic<int> busyWorkers{0};
+        std::atomic<uint64_t> generation{0};
+};
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,46 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+#include <atomic>
+#include <cstdint>
+
+// @brief
+// hands the latest value from one writer thread to one reader thread without locks
+// the writer fills its back buffer and swaps it with the middle one, the reader swaps its
+// front buffer with the middle one when a fresh value is there, neither ever waits for the other
+// the buffers are reused, so a writer that keeps its vectors sized doesn't allocate
+template<typename T>
+class TripleBuffer{
+    public:
+        // @brief
+        // writer side: the buffer to fill, it still holds the value of two publishes ago
+        T& back() { return buffers[backIndex]; }
+
+        // @brief
+        // writer side: makes the back buffer the latest value
+        void publish(){
+            backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX;
+        }
+
+        // @brief
+        // reader side: takes the latest published value, returns false if nothing new arrived
+        bool acquire(){
+            if (!(middle.load(std::memory_order_relaxed) & FRESH))
+                return false;
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+
+        // @brief
+        // reader side: the value taken by the last acquire()
+        const T& front() const { return buffers[frontIndex]; }
+
+    private:
+        static constexpr uint8_t INDEX = 3;
+        static constexpr uint8_t FRESH = 4;
+
+        T buffers[3];
+        uint8_t backIndex = 0;          //writer only
+        uint8_t frontIndex = 2;         //reader only
+        std::atomic<uint8_t> middle{1}; //index of the exchanged buffer, FRESH once published
+};
+#endif // TRIPLE_BUFFER_HPP
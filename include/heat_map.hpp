@@ -0,0 +1,103 @@
+#ifndef HEAT_MAP_HPP
+#define HEAT_MAP_HPP
+#include <SDL3/SDL.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <constraints.hpp>
+
+// @brief
+// the far view of a circuit: the screen is split in HEAT_TEXEL sized bins, every node adds
+// itself to the bin under it, and each bin becomes one texel of a streaming texture
+// brightness is how many nodes a bin holds, the color goes from the low wire color to the
+// high one with the share of those nodes that are high, so activity shows through
+class HeatMap{
+    public:
+        HeatMap() = default;
+        ~HeatMap() { clear(); }
+        HeatMap(const HeatMap&) = delete;
+        HeatMap& operator=(const HeatMap&) = delete;
+
+        void setRenderer(SDL_Renderer* r) { renderer = r; }
+
+        // @brief
+        // starts a frame for a screen of width x height pixels, every bin empty
+        void begin(int width, int height){
+            cols = (width + HEAT_TEXEL - 1) / HEAT_TEXEL;
+            rows = (height + HEAT_TEXEL - 1) / HEAT_TEXEL;
+            counts.assign((size_t)cols * rows, 0);
+            highs.assign((size_t)cols * rows, 0);
+        }
+
+        // @brief
+        // a node at the screen point (sx, sy), outside of the screen it is ignored
+        void add(float sx, float sy, bool high){
+            if (sx < 0 || sy < 0) return;
+            int c = (int)sx / HEAT_TEXEL;
+            int r = (int)sy / HEAT_TEXEL;
+            if (c >= cols || r >= rows) return;
+            size_t bin = (size_t)r * cols + c;
+            counts[bin]++;
+            highs[bin] += high ? 1 : 0;
+        }
+
+        // @brief
+        // uploads the bins and draws them over the whole screen
+        void draw(){
+            if (!renderer || cols <= 0 || rows <= 0) return;
+            if (!texture || textureCols != cols || textureRows != rows){
+                if (texture) SDL_DestroyTexture(texture);
+                texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, cols, rows);
+                if (!texture) return;
+                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+                SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_LINEAR);
+                textureCols = cols;
+                textureRows = rows;
+            }
+
+            void* pixels;
+            int pitch;
+            if (!SDL_LockTexture(texture, nullptr, &pixels, &pitch)) return;
+            const float full = std::log2(1.0f + HEAT_FULL_COUNT);
+            for (int r = 0; r < rows; r++){
+                Uint32* row = (Uint32*)((Uint8*)pixels + (size_t)r * pitch);
+                for (int c = 0; c < cols; c++){
+                    size_t bin = (size_t)r * cols + c;
+                    uint32_t n = counts[bin];
+                    if (n == 0){
+                        row[c] = 0;
+                        continue;
+                    }
+                    //log scale, a lone gate still shows next to a dense block
+                    float intensity = std::fmin(1.0f, std::log2(1.0f + n) / full);
+                    float on = (float)highs[bin] / n;
+                    //the wire colors: {100, 0, 0} low, {0, 255, 0} high
+                    Uint32 red = (Uint32)(100 * (1 - on) + 0.5f);
+                    Uint32 green = (Uint32)(255 * on + 0.5f);
+                    Uint32 alpha = (Uint32)(64 + 191 * intensity);
+                    row[c] = (alpha << 24) | (red << 16) | (green << 8);
+                }
+            }
+            SDL_UnlockTexture(texture);
+
+            SDL_FRect dst = {0, 0, (float)cols * HEAT_TEXEL, (float)rows * HEAT_TEXEL};
+            SDL_RenderTexture(renderer, texture, nullptr, &dst);
+        }
+
+        // @brief
+        // frees the texture, call it before the renderer is destroyed or when the device was lost
+        void clear(){
+            if (texture) SDL_DestroyTexture(texture);
+            texture = nullptr;
+            textureCols = textureRows = 0;
+        }
+
+    private:
+        SDL_Renderer* renderer = nullptr;
+        SDL_Texture* texture = nullptr;
+        int textureCols = 0, textureRows = 0;
+        int cols = 0, rows = 0;
+        std::vector<uint32_t> counts; //nodes per bin
+        std::vector<uint32_t> highs;  //high nodes per bin
+};
+#endif // HEAT_MAP_HPP
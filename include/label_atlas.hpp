@@ -0,0 +1,216 @@
+#ifndef LABEL_ATLAS_HPP
+#define LABEL_ATLAS_HPP
+#include <SDL3/SDL.h>
+#include <SDL_ttf.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// edge of an atlas page, a label wider than this gets a page of its own
+constexpr int LABEL_PAGE_SIZE = 512;
+
+// @brief
+// every label text is rasterized once per font size and packed into a shared texture page
+// components only keep the id of their label, so 100k "AND" gates share the pixels of one
+// the pages are filled shelf by shelf: labels go left to right on the current shelf
+// and a new shelf opens under it when the row is full
+// drawing queues textured quads per page, all labels of a page go out in one call
+class LabelAtlas{
+    public:
+        struct Label{
+            int page;
+            SDL_FRect src; //pixels of the label on its page
+        };
+
+        LabelAtlas() = default;
+        ~LabelAtlas() { destroyPages(); }
+        LabelAtlas(const LabelAtlas&) = delete;
+        LabelAtlas& operator=(const LabelAtlas&) = delete;
+
+        void setRenderer(SDL_Renderer* r) { renderer = r; }
+
+        // @brief
+        // screen = (world - origin) * scale for the labels queued after the call, the text scales too
+        void setView(float originX, float originY, float scale){
+            viewX = originX;
+            viewY = originY;
+            viewScale = scale;
+        }
+
+        // @brief
+        // id of the label for text in that font, rasterized on first use, -1 if it can't be drawn
+        int get(TTF_Font* font, const std::string& text){
+            if (!renderer || !font || text.empty()) return -1;
+            std::string key = text;
+            key += '\0';
+            key += std::to_string(TTF_GetFontSize(font));
+            auto it = ids.find(key);
+            if (it != ids.end()) return it->second;
+
+            Entry entry = {font, text, {-1, {0, 0, 0, 0}}};
+            if (!rasterize(entry)) return -1;
+            int id = (int)entries.size();
+            entries.push_back(entry);
+            ids.emplace(key, id);
+            return id;
+        }
+
+        const Label& label(int id) const { return entries[id].label; }
+
+        // @brief
+        // adds a label with its top left corner at the world point (x, y) to the queue of its page
+        void queue(int id, float x, float y){
+            const Label& l = entries[id].label;
+            if (l.page < 0) return;
+            x = (x - viewX) * viewScale;
+            y = (y - viewY) * viewScale;
+            const float w = l.src.w * viewScale;
+            const float h = l.src.h * viewScale;
+            std::vector<SDL_Vertex>& v = pages[l.page].vertices;
+            std::vector<int>& ix = pages[l.page].indices;
+            float u0 = l.src.x / pages[l.page].width;
+            float v0 = l.src.y / pages[l.page].height;
+            float u1 = (l.src.x + l.src.w) / pages[l.page].width;
+            float v1 = (l.src.y + l.src.h) / pages[l.page].height;
+            SDL_FColor white = {1, 1, 1, 1};
+            int base = (int)v.size();
+            v.push_back({{x, y}, white, {u0, v0}});
+            v.push_back({{x + w, y}, white, {u1, v0}});
+            v.push_back({{x + w, y + h}, white, {u1, v1}});
+            v.push_back({{x, y + h}, white, {u0, v1}});
+            const int corners[6] = {0, 1, 2, 0, 2, 3};
+            for (int k : corners) ix.push_back(base + k);
+        }
+
+        // @brief
+        // draws the queued labels, one SDL_RenderGeometry call per page
+        void flush(){
+            for (Page& page : pages){
+                if (!page.vertices.empty()){
+                    SDL_RenderGeometry(renderer, page.texture, page.vertices.data(), (int)page.vertices.size(),
+                                       page.indices.data(), (int)page.indices.size());
+                }
+                page.vertices.clear();
+                page.indices.clear();
+            }
+        }
+
+        // @brief
+        // frees every page, call it before the renderer is destroyed
+        void clear(){
+            destroyPages();
+            entries.clear();
+            ids.clear();
+        }
+
+        // @brief
+        // the device lost its textures (SDL_EVENT_RENDER_DEVICE_RESET), packs every label again
+        // the ids don't change, so the components keep theirs
+        void rebuild(){
+            destroyPages();
+            for (Entry& entry : entries) rasterize(entry);
+        }
+
+    private:
+        struct Entry{
+            TTF_Font* font;
+            std::string text;
+            Label label;
+        };
+
+        struct Page{
+            SDL_Texture* texture;
+            int width, height;
+            int shelfY = 0;      //top of the current shelf
+            int shelfHeight = 0; //tallest label on it
+            int cursorX = 0;     //where the next label goes on it
+            std::vector<SDL_Vertex> vertices;
+            std::vector<int> indices;
+        };
+
+        SDL_Renderer* renderer = nullptr;
+        float viewX = 0;
+        float viewY = 0;
+        float viewScale = 1;
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, int> ids; //text + font size -> entry
+        std::vector<Page> pages;
+        int shelfPage = -1; //page being filled shelf by shelf, the oversized labels' pages never are
+
+        void destroyPages(){
+            for (Page& page : pages){
+                if (page.texture) SDL_DestroyTexture(page.texture);
+            }
+            pages.clear();
+            shelfPage = -1;
+        }
+
+        int addPage(int width, int height){
+            Page page = {};
+            page.width = width;
+            page.height = height;
+            page.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+            if (!page.texture) return -1;
+            SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+            //static textures start undefined, clear to transparent
+            std::vector<Uint32> blank((size_t)width * height, 0);
+            SDL_UpdateTexture(page.texture, nullptr, blank.data(), width * 4);
+            pages.push_back(std::move(page));
+            return (int)pages.size() - 1;
+        }
+
+        // @brief
+        // finds room on the shelf page (or a new one) for a w x h box, returns the page
+        int place(int w, int h, int& outX, int& outY){
+            if (w > LABEL_PAGE_SIZE || h > LABEL_PAGE_SIZE){
+                outX = 0;
+                outY = 0;
+                return addPage(w, h);
+            }
+            if (shelfPage >= 0){
+                Page& page = pages[shelfPage];
+                if (page.cursorX + w > page.width){ //shelf full, open the next one
+                    page.shelfY += page.shelfHeight + 1;
+                    page.shelfHeight = 0;
+                    page.cursorX = 0;
+                }
+                if (page.shelfY + h <= page.height){
+                    outX = page.cursorX;
+                    outY = page.shelfY;
+                    page.cursorX += w + 1; //1px gap so filtering doesn't bleed between labels
+                    if (h > page.shelfHeight) page.shelfHeight = h;
+                    return shelfPage;
+                }
+            }
+            int index = addPage(LABEL_PAGE_SIZE, LABEL_PAGE_SIZE);
+            if (index < 0) return -1;
+            shelfPage = index;
+            pages[index].cursorX = w + 1;
+            pages[index].shelfHeight = h;
+            outX = 0;
+            outY = 0;
+            return index;
+        }
+
+        bool rasterize(Entry& entry){
+            entry.label.page = -1;
+            SDL_Color color = {255, 255, 255, 255}; //white text color
+            SDL_Surface* surface = TTF_RenderText_Blended(entry.font, entry.text.c_str(), 0, color);
+            if (!surface) return false;
+            SDL_Surface* pixels = surface->format == SDL_PIXELFORMAT_ARGB8888
+                                ? surface : SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+
+            int x = 0, y = 0;
+            int page = pixels ? place(pixels->w, pixels->h, x, y) : -1;
+            if (page >= 0){
+                SDL_Rect dst = {x, y, pixels->w, pixels->h};
+                SDL_UpdateTexture(pages[page].texture, &dst, pixels->pixels, pixels->pitch);
+                entry.label = {page, {(float)x, (float)y, (float)pixels->w, (float)pixels->h}};
+            }
+
+            if (pixels && pixels != surface) SDL_DestroySurface(pixels);
+            SDL_DestroySurface(surface); //free the CPU surface
+            return page >= 0;
+        }
+};
+#endif // LABEL_ATLAS_HPP
@@ -0,0 +1,111 @@
+#ifndef RENDER_BATCH_HPP
+#define RENDER_BATCH_HPP
+#include <SDL3/SDL.h>
+#include <cmath>
+#include <vector>
+
+// @brief
+// collects the untextured shapes of a frame into one vertex buffer
+// every shape is made of quads with the color stored per vertex, so colors don't split the batch
+// and the whole scene goes to the gpu with a single SDL_RenderGeometry call, in submission order
+// shapes are given in world coordinates and mapped through the view, outlines and line widths
+// stay in screen pixels so they don't vanish when zoomed out
+class RenderBatch{
+    public:
+        // @brief
+        // screen = (world - origin) * scale, for every shape added after the call
+        void setView(float originX, float originY, float scale){
+            viewX = originX;
+            viewY = originY;
+            viewScale = scale;
+        }
+
+        void clear(){
+            vertices.clear();
+            indices.clear();
+        }
+
+        bool empty() const { return vertices.empty(); }
+
+        void fillRect(const SDL_FRect& r, SDL_Color color){
+            fillScreenRect(toScreen(r), color);
+        }
+
+        // @brief
+        // 1px outline on the inside of the rect, same pixels as SDL_RenderRect
+        void rect(const SDL_FRect& r, SDL_Color color){
+            SDL_FRect s = toScreen(r);
+            if (s.w <= 2 || s.h <= 2){
+                fillScreenRect(s, color);
+                return;
+            }
+            fillScreenRect({s.x, s.y, s.w, 1}, color);
+            fillScreenRect({s.x, s.y + s.h - 1, s.w, 1}, color);
+            fillScreenRect({s.x, s.y + 1, 1, s.h - 2}, color);
+            fillScreenRect({s.x + s.w - 1, s.y + 1, 1, s.h - 2}, color);
+        }
+
+        // @brief
+        // line as a thin quad, the ends are extended by half the width so joints don't leave gaps
+        // the thickness is in screen pixels
+        void line(float x0, float y0, float x1, float y1, SDL_Color color, float thickness = 1.0f){
+            x0 = (x0 - viewX) * viewScale;
+            y0 = (y0 - viewY) * viewScale;
+            x1 = (x1 - viewX) * viewScale;
+            y1 = (y1 - viewY) * viewScale;
+            float dx = x1 - x0;
+            float dy = y1 - y0;
+            float length = std::sqrt(dx * dx + dy * dy);
+            if (length < 1e-3f){
+                fillScreenRect({x0 - thickness / 2, y0 - thickness / 2, thickness, thickness}, color);
+                return;
+            }
+            float half = thickness / 2;
+            float ux = dx / length * half; //along the line
+            float uy = dy / length * half;
+            float nx = -uy;                //across
+            float ny = ux;
+            quad({x0 - ux + nx, y0 - uy + ny}, {x1 + ux + nx, y1 + uy + ny},
+                 {x1 + ux - nx, y1 + uy - ny}, {x0 - ux - nx, y0 - uy - ny}, toFColor(color));
+        }
+
+        // @brief
+        // draws everything collected so far and empties the batch
+        void flush(SDL_Renderer* renderer){
+            if (!vertices.empty()){
+                SDL_RenderGeometry(renderer, nullptr, vertices.data(), (int)vertices.size(),
+                                   indices.data(), (int)indices.size());
+            }
+            clear();
+        }
+
+    private:
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+        float viewX = 0;
+        float viewY = 0;
+        float viewScale = 1;
+
+        SDL_FRect toScreen(const SDL_FRect& r) const {
+            return {(r.x - viewX) * viewScale, (r.y - viewY) * viewScale, r.w * viewScale, r.h * viewScale};
+        }
+
+        void fillScreenRect(const SDL_FRect& r, SDL_Color color){
+            quad({r.x, r.y}, {r.x + r.w, r.y}, {r.x + r.w, r.y + r.h}, {r.x, r.y + r.h}, toFColor(color));
+        }
+
+        static SDL_FColor toFColor(SDL_Color c){
+            return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f};
+        }
+
+        void quad(SDL_FPoint a, SDL_FPoint b, SDL_FPoint c, SDL_FPoint d, SDL_FColor color){
+            int base = (int)vertices.size();
+            vertices.push_back({a, color, {0, 0}});
+            vertices.push_back({b, color, {0, 0}});
+            vertices.push_back({c, color, {0, 0}});
+            vertices.push_back({d, color, {0, 0}});
+            const int corners[6] = {0, 1, 2, 0, 2, 3};
+            for (int k : corners) indices.push_back(base + k);
+        }
+};
+#endif // RENDER_BATCH_HPP
@@ -0,0 +1,114 @@
+#ifndef SPATIAL_GRID_HPP
+#define SPATIAL_GRID_HPP
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include <constraints.hpp>
+
+// cell edge of the spatial index, a few grid steps so a component covers 1-4 cells
+constexpr int SPATIAL_CELL_SIZE = 8 * GRID_SIZE;
+
+// @brief
+// uniform grid over the canvas, maps cells to the ids of the components overlapping them
+// a point lookup only tests the components of one cell instead of the whole circuit
+// cells are hashed so the canvas has no fixed size
+class SpatialGrid{
+    public:
+        // @brief
+        // (re)places id over the box, only touches the cells if the covered range changed
+        void update(int id, float minX, float minY, float maxX, float maxY){
+            Range r = {cellOf(minX), cellOf(minY), cellOf(maxX), cellOf(maxY), true};
+            if (id >= (int)ranges.size()) ranges.resize(id + 1);
+            Range& old = ranges[id];
+            if (old.used && old.x0 == r.x0 && old.y0 == r.y0 && old.x1 == r.x1 && old.y1 == r.y1)
+                return;
+            remove(id);
+            for (int cy = r.y0; cy <= r.y1; cy++)
+                for (int cx = r.x0; cx <= r.x1; cx++)
+                    cells[key(cx, cy)].push_back(id);
+            ranges[id] = r;
+        }
+
+        void remove(int id){
+            if (id >= (int)ranges.size() || !ranges[id].used) return;
+            Range& r = ranges[id];
+            for (int cy = r.y0; cy <= r.y1; cy++){
+                for (int cx = r.x0; cx <= r.x1; cx++){
+                    auto it = cells.find(key(cx, cy));
+                    if (it == cells.end()) continue;
+                    std::vector<int>& ids = it->second;
+                    for (size_t k = 0; k < ids.size(); k++){
+                        if (ids[k] == id){
+                            ids[k] = ids.back(); //order inside a cell doesn't matter
+                            ids.pop_back();
+                            break;
+                        }
+                    }
+                    if (ids.empty()) cells.erase(it);
+                }
+            }
+            r.used = false;
+        }
+
+        void clear(){
+            cells.clear();
+            ranges.clear();
+        }
+
+        // @brief
+        // calls fn(id) for every component whose box may contain the point
+        template<typename Fn>
+        void queryPoint(float x, float y, Fn&& fn) const {
+            auto it = cells.find(key(cellOf(x), cellOf(y)));
+            if (it == cells.end()) return;
+            for (int id : it->second) fn(id);
+        }
+
+        // @brief
+        // calls fn(id) once for every component whose cells overlap the box
+        // an id is only reported from the first of its cells inside the box, so no set is needed
+        // a box with more cells than there are occupied ones walks the occupied cells instead
+        template<typename Fn>
+        void queryRect(float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+            const int x0 = cellOf(minX), y0 = cellOf(minY), x1 = cellOf(maxX), y1 = cellOf(maxY);
+            auto visit = [&](int cx, int cy, const std::vector<int>& ids){
+                for (int id : ids){
+                    const Range& r = ranges[id];
+                    if (cx == std::max(r.x0, x0) && cy == std::max(r.y0, y0)) fn(id);
+                }
+            };
+            if ((uint64_t)(x1 - x0 + 1) * (uint64_t)(y1 - y0 + 1) > cells.size()){
+                for (const auto& cell : cells){
+                    int cx = (int)(int32_t)(cell.first >> 32);
+                    int cy = (int)(int32_t)(uint32_t)cell.first;
+                    if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1) visit(cx, cy, cell.second);
+                }
+                return;
+            }
+            for (int cy = y0; cy <= y1; cy++){
+                for (int cx = x0; cx <= x1; cx++){
+                    auto it = cells.find(key(cx, cy));
+                    if (it != cells.end()) visit(cx, cy, it->second);
+                }
+            }
+        }
+
+    private:
+        struct Range{
+            int x0, y0, x1, y1;
+            bool used;
+        };
+
+        std::unordered_map<uint64_t, std::vector<int>> cells;
+        std::vector<Range> ranges; //cells covered by every id
+
+        static int cellOf(float v){
+            return (int)std::floor(v / SPATIAL_CELL_SIZE);
+        }
+        static uint64_t key(int cx, int cy){
+            return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+        }
+};
+#endif // SPATIAL_GRID_HPP
@@ -3,10 +3,8 @@
 #include <imgui.h>
 #include <backends/imgui_impl_sdl3.h>
 #include <backends/imgui_impl_sdlrenderer3.h>
-#include <fstream> //file reading and writing as to save the progress
-#include <json.hpp>
-
-using json = nlohmann::json;
+#include <circuit_io.hpp> //file reading and writing as to save the progress
+#include <cmath>
 
 Application::Application()
 {
@@ -44,10 +42,14 @@ bool Application::init()
     if (!renderer)
         return false;
 
-    // 5. Logical Presentation (Auto-scaling)
-    SDL_SetRenderLogicalPresentation(renderer, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_LOGICAL_PRESENTATION_LETTERBOX);
+    // 5. No logical presentation, a bigger window shows more of the canvas through the camera
+
+    // 6. Background grid, rendered once and tiled every frame
+    buildGridTexture();
+    labels.setRenderer(renderer);
+    heatMap.setRenderer(renderer);
 
-    // 6. Load Font
+    // 7. Load Font
     font = TTF_OpenFont("font.ttf", 20);
     if (!font)
     {
@@ -67,6 +69,19 @@ bool Application::init()
     ImGui_ImplSDL3_InitForSDLRenderer(window, renderer);
     ImGui_ImplSDLRenderer3_Init(renderer);
 
+    // 8. Simulation thread, every snapshot it publishes wakes the frame loop
+    simEventType = SDL_RegisterEvents(1);
+    simWorker.setPublishCallback([this] {
+        if (simEventType != 0 && !simEventPosted.exchange(true))
+        {
+            SDL_Event wake;
+            SDL_zero(wake);
+            wake.type = simEventType;
+            SDL_PushEvent(&wake);
+        }
+    });
+    simWorker.start();
+
     return true;
 }
 
@@ -76,9 +91,29 @@ void Application::run()
         return;
     while (isRunning)
     {
+        //nothing to draw, sleep until the next event, a new snapshot is one too
+        //the events aren't consumed here, handleEvents() reads them
+        if (redrawFrames == 0)
+        {
+            SDL_WaitEventTimeout(nullptr, IDLE_WAIT_MS);
+        }
+
+        Uint64 frameStart = SDL_GetTicksNS();
         handleEvents();
         update();
-        render();
+        if (redrawFrames > 0)
+        {
+            redrawFrames--;
+            render();
+        }
+
+        if (frameCap > 0)
+        {
+            Uint64 frameTime = SDL_NS_PER_SECOND / frameCap;
+            Uint64 elapsed = SDL_GetTicksNS() - frameStart;
+            if (elapsed < frameTime)
+                SDL_DelayPrecise(frameTime - elapsed);
+        }
     }
 }
 
@@ -89,45 +124,84 @@ void Application::handleEvents()
     while (SDL_PollEvent(&event))
     {
         ImGui_ImplSDL3_ProcessEvent(&event);
+        //any input or window event may change what's on screen
+        requestRedraw();
         if (event.type == SDL_EVENT_QUIT)
         {
             isRunning = false;
         }
+        //target textures lose their content when the device is lost (e.g. direct3d resets)
+        if (event.type == SDL_EVENT_RENDER_TARGETS_RESET || event.type == SDL_EVENT_RENDER_DEVICE_RESET)
+        {
+            buildGridTexture();
+        }
+        //a lost device takes every texture with it, the label pages too
+        if (event.type == SDL_EVENT_RENDER_DEVICE_RESET)
+        {
+            labels.rebuild();
+            heatMap.clear(); //recreated by the next far view
+        }
 
 
         //stop main frame if mouse on UI
         ImGuiIO& io = ImGui::GetIO();
         if(io.WantCaptureMouse) continue;
+        //keys typed into an imgui field (the inspector) don't edit the circuit
+        if(io.WantCaptureKeyboard && event.type == SDL_EVENT_KEY_DOWN) continue;
 
         SDL_GetMouseState(&rawMouseX, &rawMouseY);
 
-        // set render coord
-        SDL_RenderCoordinatesFromWindow(renderer, rawMouseX, rawMouseY, &mouseX, &mouseY);
+        // set render coord, then the world point under it
+        float lastScreenX = screenX;
+        float lastScreenY = screenY;
+        SDL_RenderCoordinatesFromWindow(renderer, rawMouseX, rawMouseY, &screenX, &screenY);
+        SDL_FPoint world = camera.toWorld(screenX, screenY);
+        mouseX = world.x;
+        mouseY = world.y;
+
+        // camera: right or middle drag pans, the wheel zooms around the cursor
+        bool panButton = (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN || event.type == SDL_EVENT_MOUSE_BUTTON_UP) &&
+                         (event.button.button == SDL_BUTTON_RIGHT || event.button.button == SDL_BUTTON_MIDDLE);
+        if (panButton)
+        {
+            isPanning = event.type == SDL_EVENT_MOUSE_BUTTON_DOWN;
+            continue;
+        }
+        if (event.type == SDL_EVENT_MOUSE_MOTION && isPanning)
+        {
+            camera.pan(screenX - lastScreenX, screenY - lastScreenY);
+            continue;
+        }
+        if (event.type == SDL_EVENT_MOUSE_WHEEL)
+        {
+            camera.zoomAt(screenX, screenY, std::pow(1.1f, event.wheel.y));
+            continue;
+        }
 
         // check for mouse click
         if (event.type == SDL_EVENT_MOUSE_BUTTON_DOWN)
         {
 
             bool clickedSomething = false; // to track if we hit anything
-            // loop through components to see if we clicked one
-            for (Component *comp : components)
+            // only the components around the cursor are tested
+            HitZone zone = HIT_NONE;
+            int port = -1;
+            Component *comp = pick(mouseX, mouseY, zone, port);
+            if (comp)
             {
-                HitZone zone = comp->getHitZone(mouseX, mouseY);
-
                 if (zone == HIT_OUTPUT)
                 {
                     // start wiring
                     isWiring = true;
-                    wiringSource = comp;
+                    wiringFrom = netlist.handle(comp->netId);
                     clickedSomething = true;
 
                     // note: we dont change selection when wiring, usually better UX
-                    break; // break so we cannot click on 2 things
                 }
                 else if (zone == HIT_BODY)
                 {
                     // select it
-                    selectedComponent = comp;
+                    selected = netlist.handle(comp->netId);
                     clickedSomething = true;
 
                     // start dragging
@@ -135,165 +209,98 @@ void Application::handleEvents()
                     comp->dragOffsetX = mouseX - comp->x;
                     comp->dragOffsetY = mouseY - comp->y;
 
-                    // toggle switch (on or off)
-                    Input_Switch *sw = dynamic_cast<Input_Switch *>(comp);
-                    if (sw)
+                    // toggle switch (on or off), a bus switch is set from the inspector
+                    if (netlist.type(comp->netId) == GATE_SWITCH && netlist.width(comp->netId) == 1)
                     {
-                        sw->toggle();
+                        bool on = !netlist.state(comp->netId);
+                        netlist.setState(comp->netId, on);
+                        simWorker.setSwitch(comp->netId, on);
                     }
-                    break;
                 }
             }
 
             // if we click on nothing deselect
             if (!clickedSomething)
             {
-                selectedComponent = false;
+                selected = NodeHandle();
             }
         }
         if (event.type == SDL_EVENT_MOUSE_BUTTON_UP)
         {
             // if we were dragging a wire, try dropping it
-            if (isWiring && wiringSource != nullptr)
+            Component* source = view(wiringFrom);
+            if (isWiring && source != nullptr)
             {
-                bool connectionMade = false;
+                int port = -1;
+                HitZone zone = HIT_NONE;
+                Component *comp = pick(mouseX, mouseY, zone, port);
 
-                for (Component *comp : components)
+                // dropped on an input, port tells which one
+                if (comp && zone == HIT_INPUT && netlist.connect(comp->netId, port, source->netId))
                 {
-                    HitZone zone = comp->getHitZone(mouseX, mouseY);
-
-                    // case 1 : dropped on top input
-                    if (zone == HIT_INPUT1)
-                    {
-                        // and gate
-                        if (auto gate = dynamic_cast<And_Gate *>(comp))
-                        {
-                            gate->attachInput1(wiringSource);
-                            connectionMade = true;
-                        }
-                        // or gate
-                        else if (auto gate = dynamic_cast<Or_Gate *>(comp))
-                        {
-                            gate->attachInput1(wiringSource);
-                            connectionMade = true;
-                        }
-                        // not gate
-                        else if (auto gate = dynamic_cast<Not_Gate *>(comp))
-                        {
-                            gate->attach(wiringSource);
-                            connectionMade = true;
-                        }
-                        // light bulb
-                        else if (auto light = dynamic_cast<Output_Light *>(comp))
-                        {
-                            light->attach(wiringSource);
-                            connectionMade = true;
-                        }
-                    }
-
-                    // case 2: dropped on bottom inpu
-                    else if (zone == HIT_INPUT2)
-                    {
-                        // and gate
-                        if (auto gate = dynamic_cast<And_Gate *>(comp))
-                        {
-                            gate->attachInput2(wiringSource);
-                            connectionMade = true;
-                        }
-                        // or gate
-                        else if (auto gate = dynamic_cast<Or_Gate *>(comp))
-                        {
-                            gate->attachInput2(wiringSource);
-                            connectionMade = true;
-                        }
-                    }
-
-                    if (connectionMade)
-                        break;
+                    simWorker.connect(comp->netId, port, source->netId);
+                    collectLongWires();
                 }
             }
 
-            // reset states
+            // reset states, the netlist keeps the layout for saving
             isWiring = false;
-            wiringSource = nullptr;
+            wiringFrom = NodeHandle();
+            bool dropped = false;
             for (Component *comp : components)
-                comp->isDragging = false;
+            {
+                if (comp && comp->isDragging)
+                {
+                    comp->isDragging = false;
+                    netlist.setPosition(comp->netId, comp->x, comp->y);
+                    dropped = true;
+                }
+            }
+            // its wires may have become long or short
+            if (dropped)
+                collectLongWires();
         }
         if (event.type == SDL_EVENT_MOUSE_MOTION)
         {
             for (Component *comp : components)
             {
-                if (comp->isDragging)
+                if (comp && comp->isDragging)
                 {   
                     float rawX = mouseX - comp->dragOffsetX;
                     float rawY = mouseY - comp->dragOffsetY;
 
-                    comp->x = (float)((int)rawX/GRID_SIZE)*GRID_SIZE;
-                    comp->y = (float)((int)rawY/GRID_SIZE)*GRID_SIZE;
+                    //floor, the canvas goes into negative coordinates now
+                    comp->x = std::floor(rawX / GRID_SIZE) * GRID_SIZE;
+                    comp->y = std::floor(rawY / GRID_SIZE) * GRID_SIZE;
+                    indexComponent(comp);
                 }
             }
         }
 
         if (event.type == SDL_EVENT_KEY_DOWN)
         {
+            // home brings the camera back to the origin
+            if (event.key.key == SDLK_HOME)
+            {
+                camera = Camera();
+            }
             // check for delete and backspace
             if (event.key.key == SDLK_DELETE || event.key.key == SDLK_BACKSPACE)
             {
-                if (selectedComponent != nullptr)
+                int node = netlist.resolve(selected);
+                if (node >= 0)
                 {
-                    // safety: disconnect incoming wires
-                    // we iterate through all components to see if any are connected to the one we r deleting
-                    for (Component *other : components)
-                    {
-                        // check and gate
-                        if (auto gate = dynamic_cast<And_Gate *>(other))
-                        {
-                            if (gate->input1 == selectedComponent)
-                                gate->input1 = nullptr;
-                            if (gate->input2 == selectedComponent)
-                                gate->input2 = nullptr;
-                        }
-                        // check or gate
-                        else if (auto gate = dynamic_cast<Or_Gate *>(other))
-                        {
-                            if (gate->input1 == selectedComponent)
-                                gate->input1 = nullptr;
-                            if (gate->input2 == selectedComponent)
-                                gate->input2 = nullptr;
-                        }
-                        // check not gate
-                        else if (auto gate = dynamic_cast<Not_Gate *>(other))
-                        {
-                            if (gate->source == selectedComponent)
-                                gate->source = nullptr;
-                        }
-                        // check light input
-                        else if (auto light = dynamic_cast<Output_Light *>(other))
-                        {
-                            if (light->source == selectedComponent)
-                                light->source = nullptr;
-                        }
-                    }
-
-                    // safety: if we are currently wiring from this object
-                    // stop wiring
-                    if (wiringSource == selectedComponent)
-                    {
-                        isWiring = false;
-                        wiringSource = nullptr;
-                    }
-
-                    // remove from the list
-                    // find component in vector and delete
-                    auto it = std::find(components.begin(), components.end(), selectedComponent);
-                    if (it != components.end())
-                    {
-                        components.erase(it);
-                    }
-
-                    // delete memory
-                    delete selectedComponent;
-                    selectedComponent = nullptr;
+                    // the handles to it (selection, wiring) stop resolving by themselves
+                    GateType type = netlist.type(node);
+                    netlist.remove(node);
+                    simWorker.remove(node);
+
+                    // the next node added takes the index over, leave a hole until then
+                    componentPool.destroy(components[node], type);
+                    components[node] = nullptr;
+                    spatialIndex.remove(node);
+                    selected = NodeHandle();
+                    collectLongWires();
                 }
             }
         }
@@ -302,137 +309,137 @@ void Application::handleEvents()
 
 void Application::update()
 {
-    for (Component *comp : components)
+    // the simulation runs on its own thread, take the latest state it published
+    // the flag is cleared first so a snapshot published after acquire() posts a new wakeup
+    simEventPosted.store(false);
+    if (simWorker.acquire())
     {
-        comp->calculate();
+        requestRedraw();
     }
 }
 
-void Application::saveCircuit(const std::string& filename){
-    json j_scene = json::array(); //root array
-
-    //serialize every component
-    for(int i=0; i<components.size();i++){
-        Component* comp = components[i];
-        json j_comp;
+// @brief
+// adds a new node to the circuit (netlist and simulation thread) and its view
+// the node may reuse a removed index, components[i] stays the view of node i
+Component* Application::createComponent(GateType type, float x, float y)
+{
+    if (type >= GATE_TYPE_COUNT)
+        return nullptr;
+    int node = netlist.add(type, x, y);
+    simWorker.add(type);
+    if (node >= (int)components.size())
+        components.resize(node + 1, nullptr);
+    components[node] = createView(node);
+    return components[node];
+}
 
-        j_comp["id"] = i; //save index
-        j_comp["type"] = comp->getType(); //save type
-        j_comp["x"] = comp->x;
-        j_comp["y"] = comp->y;
+// @brief
+// builds the view of an existing netlist node, its label and its hit-testing entry
+Component* Application::createView(int node)
+{
+    Component* comp = componentPool.create(netlist.type(node), netlist.x(node), netlist.y(node));
+    if (!comp)
+        return nullptr;
+    comp->netId = node;
+    comp->setInputCount(netlist.inputCount(node));
+    comp->createLabel(labels, font);
+    indexComponent(comp);
+    return comp;
+}
 
+// @brief
+// the view a handle points to, nullptr once its node was removed
+Component* Application::view(NodeHandle h)
+{
+    int node = netlist.resolve(h);
+    return node >= 0 ? components[node] : nullptr;
+}
 
-        //handle wiring
-        //helper lambda to find index of source pointer
-        auto getIndex = [&](Component* target) -> int{
-            if(!target){
-                return -1;
-            }
-            auto it = std::find(components.begin(), components.end(), target);
-            if(it != components.end()){
-                return std::distance(components.begin(), it);
-            }
-            return -1;
-        };
+// @brief
+// keeps the spatial index in sync with the component box, pins stick out 10 pixels
+void Application::indexComponent(Component* comp)
+{
+    spatialIndex.update(comp->netId, comp->x - 10, comp->y - 10,
+                        comp->x + comp->width + 10, comp->y + comp->height + 10);
+}
 
-        if (auto g = dynamic_cast<And_Gate*>(comp)) {
-            j_comp["in1"] = getIndex(g->input1);
-            j_comp["in2"] = getIndex(g->input2);
-        }
-        else if (auto g = dynamic_cast<Or_Gate*>(comp)) {
-            j_comp["in1"] = getIndex(g->input1);
-            j_comp["in2"] = getIndex(g->input2);
-        }
-        else if (auto g = dynamic_cast<Not_Gate*>(comp)) {
-            j_comp["src"] = getIndex(g->source);
-        }
-        else if (auto l = dynamic_cast<Output_Light*>(comp)) {
-            j_comp["src"] = getIndex(l->source);
+// @brief
+// the topmost component under the cursor and the zone that was hit, port is set for HIT_INPUT
+// components are drawn in id order, so the highest id is on top
+Component* Application::pick(float mx, float my, HitZone& zone, int& port)
+{
+    Component* hit = nullptr;
+    zone = HIT_NONE;
+    spatialIndex.queryPoint(mx, my, [&](int id) {
+        Component* comp = components[id];
+        if (hit && hit->netId > id)
+            return;
+        int p = -1;
+        HitZone z = comp->getHitZone(mx, my, p);
+        if (z != HIT_NONE)
+        {
+            hit = comp;
+            zone = z;
+            port = p;
         }
+    });
+    return hit;
+}
 
-        j_scene.push_back(j_comp);
-    }
-
-    //write to file
-    std::ofstream file(filename);
-    if(file.is_open()){
-        file<<j_scene.dump(4);//4 space indent
-        file.close();
+void Application::saveCircuit(const std::string& filename){
+    if(saveCircuitFile(netlist, filename)){
         std::cout<<"Saved to: "<<filename<<std::endl;
     }
 }
 
 void Application::loadCircuit(const std::string& filename){
-    std::ifstream file(filename);
-    if(!file.is_open()){
-        std::cout<<"Failed to open: "<<filename<<std::endl;
+    Netlist loaded;
+    if(!loadCircuitFile(loaded, filename)){
+        std::cout<<"Failed to load: "<<filename<<std::endl;
         return;
     }
 
-    json j_scene;
-    file>>j_scene; //parse JSON
-
-    //clear old scene
-    for(Component* c: components){
-        delete c;
-    }
+    //clear old scene, the views go all at once with their arenas
+    componentPool.reset();
     components.clear();
-    selectedComponent = nullptr;
-    wiringSource = nullptr;
+    spatialIndex.clear();
+    selected = NodeHandle();
+    wiringFrom = NodeHandle();
     isWiring = false;
 
+    //the simulation thread gets its own copy of the new circuit
+    netlist = std::move(loaded);
+    simWorker.load(netlist);
 
-    //create objects (no wiring)
-    for(const auto& item: j_scene){
-        std::string type = item["type"];
-        float x = item["x"];
-        float y = item["y"];
-
-        Component* newComp = nullptr;
-
-        if (type == "AND") newComp = new And_Gate(x, y);
-        else if (type == "OR") newComp = new Or_Gate(x, y);
-        else if (type == "NOT") newComp = new Not_Gate(x, y);
-        else if (type == "SWITCH") newComp = new Input_Switch(x, y);
-        else if (type == "LIGHT") newComp = new Output_Light(x, y);
-
-        if(newComp){
-            //re-create the label texture
-            newComp->labelText = (type == "SWITCH" ? "Input" : type);
-            if(type == "LIGHT"){
-                newComp->labelText = "Light";
-            }
-            newComp->createLabelTexture(renderer,font);
-
-            components.push_back(newComp);
-        }
+    //create the views, the loaded nodes are dense so view i is node i
+    for(int i=0; i<netlist.size(); i++){
+        components.push_back(createView(i));
     }
+    collectLongWires();
+}
 
-    //reconnect wires
-    for(int i=0; i<j_scene.size(); i++){
-        json item = j_scene[i];
-
-        Component* comp = components[i];
+// @brief
+// true if the wire reaches further than the margin culling looks around the view
+static bool isLongWire(SDL_FPoint from, SDL_FPoint to)
+{
+    return std::fabs(to.x - from.x) > LONG_WIRE_LENGTH || std::fabs(to.y - from.y) > LONG_WIRE_LENGTH;
+}
 
-        if (auto g = dynamic_cast<And_Gate*>(comp)) {
-            int idx1 = item.value("in1", -1); // value() gets key or default -1
-            int idx2 = item.value("in2", -1);
-            if (idx1 >= 0 && idx1 < components.size()) g->input1 = components[idx1];
-            if (idx2 >= 0 && idx2 < components.size()) g->input2 = components[idx2];
-        }
-        else if (auto g = dynamic_cast<Or_Gate*>(comp)) {
-            int idx1 = item.value("in1", -1);
-            int idx2 = item.value("in2", -1);
-            if (idx1 >= 0 && idx1 < components.size()) g->input1 = components[idx1];
-            if (idx2 >= 0 && idx2 < components.size()) g->input2 = components[idx2];
-        }
-        else if (auto g = dynamic_cast<Not_Gate*>(comp)) {
-            int src = item.value("src", -1);
-            if (src >= 0 && src < components.size()) g->source = components[src];
-        }
-        else if (auto l = dynamic_cast<Output_Light*>(comp)) {
-            int src = item.value("src", -1);
-            if (src >= 0 && src < components.size()) l->source = components[src];
+// @brief
+// rebuilds the list of long wires, one pass over every wire
+// called after edits and drops, moving a component doesn't change the list until it lands
+void Application::collectLongWires()
+{
+    longWires.clear();
+    for (Component *comp : components)
+    {
+        if (!comp)
+            continue;
+        for (int port = 0; port < comp->numInputs(); port++)
+        {
+            int src = netlist.input(comp->netId, port);
+            if (src >= 0 && isLongWire(components[src]->outputPin(), comp->inputPin(port)))
+                longWires.push_back({comp->netId, port});
         }
     }
 }
@@ -445,7 +452,8 @@ void Application::render()
     ImGui::NewFrame();
     //define toolbox window
     ImGui::SetNextWindowPos(ImVec2(0,0),ImGuiCond_Once);
-    ImGui::SetNextWindowSize(ImVec2(SCREEN_WIDTH,60));
+    SDL_GetCurrentRenderOutputSize(renderer, &viewWidth, &viewHeight);
+    ImGui::SetNextWindowSize(ImVec2((float)viewWidth,60));
 
     ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoTitleBar |
                                     ImGuiWindowFlags_NoResize |
@@ -457,51 +465,68 @@ void Application::render()
     //start window named toolbox
     ImGui::Begin("Toolbox", nullptr, window_flags);
 
+    //new components spawn in the middle of the view, on the grid
+    SDL_FPoint spawn = camera.toWorld(viewWidth / 2.0f, viewHeight / 2.0f);
+    spawn.x = std::floor(spawn.x / GRID_SIZE) * GRID_SIZE;
+    spawn.y = std::floor(spawn.y / GRID_SIZE) * GRID_SIZE;
+
     //button: and gate
     if (ImGui::Button("AND Gate")) {
-        //spawn in middle
-        And_Gate* newGate = new And_Gate(640, 320);
-        newGate->labelText = "AND";
-        newGate->createLabelTexture(renderer, font);
-        components.push_back(newGate);
+        createComponent(GATE_AND, spawn.x, spawn.y);
     }
     ImGui::SameLine();
 
     //button: or gate
     if (ImGui::Button("OR Gate")) {
-        Or_Gate* newGate = new Or_Gate(640, 320);
-        newGate->labelText = "OR";
-        newGate->createLabelTexture(renderer, font);
-        components.push_back(newGate);
+        createComponent(GATE_OR, spawn.x, spawn.y);
     }
     ImGui::SameLine();
     
     //button: not gate
     if (ImGui::Button("NOT Gate")) {
-        Not_Gate* newGate = new Not_Gate(640, 320);
-        newGate->labelText = "NOT";
-        newGate->createLabelTexture(renderer, font);
-        components.push_back(newGate);
+        createComponent(GATE_NOT, spawn.x, spawn.y);
     }
     ImGui::SameLine();
 
     //button: switch
     if (ImGui::Button("Switch")) {
-        Input_Switch* newSw = new Input_Switch(640, 320);
-        newSw->labelText = "Input";
-        newSw->createLabelTexture(renderer, font);
-        components.push_back(newSw);
+        createComponent(GATE_SWITCH, spawn.x, spawn.y);
     }
     ImGui::SameLine();
 
     //button: light
     if (ImGui::Button("Light")) {
-        Output_Light* newLight = new Output_Light(640, 320);
-        newLight->labelText = "Light";
-        newLight->createLabelTexture(renderer, font);
-        components.push_back(newLight);
+        createComponent(GATE_LIGHT, spawn.x, spawn.y);
     }
     ImGui::SameLine();
+
+    //the word level parts, listed from their gateInfo() rows
+    if (ImGui::Button("More...")) {
+        ImGui::OpenPopup("more_parts");
+    }
+    if (ImGui::BeginPopup("more_parts")) {
+        const GateType more[] = {GATE_NAND, GATE_NOR, GATE_XOR, GATE_XNOR, GATE_ADD, GATE_MUX, GATE_EQ, GATE_LT};
+        for (GateType type : more) {
+            if (ImGui::Selectable(gateTypeName(type)))
+                createComponent(type, spawn.x, spawn.y);
+        }
+        ImGui::Separator();
+        //clocked parts, a clock makes every simulation tick one clock cycle
+        const GateType clocked[] = {GATE_CLOCK, GATE_DFF, GATE_REG, GATE_COUNTER};
+        for (GateType type : clocked) {
+            if (ImGui::Selectable(gateTypeName(type)))
+                createComponent(type, spawn.x, spawn.y);
+        }
+        ImGui::EndPopup();
+    }
+    ImGui::SameLine();
+
+    //feedback loops that never settle, their gates are outlined in orange
+    const SimSnapshot& status = simWorker.snapshot();
+    if (status.oscillatingLoops > 0) {
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "%d oscillating loop(s)", status.oscillatingLoops);
+        ImGui::SameLine();
+    }
     float spacing = ImGui::GetContentRegionAvail().x - 120; // 120 is approx width of 2 buttons
     if (spacing > 0) ImGui::SameLine(ImGui::GetCursorPosX() + spacing);
 
@@ -515,56 +540,287 @@ void Application::render()
     //finish logic
     ImGui::End();
 
+    //inspector of the selected node: its bus width, the inputs of an n-input gate
+    //and the value of a bus switch
+    int inspected = netlist.resolve(selected);
+    if (inspected >= 0) {
+        ImGui::SetNextWindowPos(ImVec2(10, 70), ImGuiCond_Once);
+        ImGui::Begin("Inspector", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        ImGui::Text("%s #%d", gateTypeName(netlist.type(inspected)), inspected);
+
+        int width = netlist.width(inspected);
+        if (ImGui::InputInt("width", &width) && width != netlist.width(inspected)) {
+            //wires that no longer fit are opened on both sides
+            rejectedWidth = netlist.setWidth(inspected, width) ? 0 : width;
+            rejectedNode = inspected;
+            if (rejectedWidth == 0) {
+                simWorker.setWidth(inspected, netlist.width(inspected));
+                collectLongWires();
+            }
+        }
+        if (rejectedWidth != 0 && rejectedNode == inspected) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "width %d is not 1 to %d bits", rejectedWidth, MAX_WIDTH);
+        }
+
+        int inputs = netlist.inputCount(inspected);
+        if (gateInfo(netlist.type(inspected)).variadic && ImGui::InputInt("inputs", &inputs)
+            && netlist.setInputCount(inspected, inputs)) {
+            //the dropped ports lose their wires, the body grows or shrinks with the pins
+            simWorker.setInputCount(inspected, netlist.inputCount(inspected));
+            components[inspected]->setInputCount(netlist.inputCount(inspected));
+            indexComponent(components[inspected]);
+            collectLongWires();
+        }
+
+        if (netlist.type(inspected) == GATE_SWITCH && netlist.width(inspected) > 1) {
+            uint64_t value = netlist.value(inspected);
+            if (ImGui::InputScalar("set", ImGuiDataType_U64, &value, nullptr, nullptr, "%llX",
+                                   ImGuiInputTextFlags_CharsHexadecimal)) {
+                netlist.setValue(inspected, value);
+                simWorker.setSwitch(inspected, netlist.value(inspected));
+            }
+        }
+
+        unsigned long long current = simWorker.snapshot().value(inspected);
+        ImGui::Text("value %llu (0x%llX)", current, current);
+        ImGui::End();
+    }
+
     //render window
     SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
     SDL_RenderClear(renderer);
 
-    SDL_SetRenderDrawColor(renderer, 70,70,70,255);
-    for(int x=0;x<SCREEN_WIDTH;x+=GRID_SIZE){
-        SDL_RenderLine(renderer,x,0,x,SCREEN_HEIGHT);
+    drawGrid();
+
+    //node states come from the simulation thread's latest snapshot
+    const SimSnapshot& frame = simWorker.snapshot();
+
+    //far view: one heat map texel per few pixels instead of the components, wires and labels
+    if (camera.zoom < LOD_HEATMAP_ZOOM)
+    {
+        heatMap.begin(viewWidth, viewHeight);
+        for (int i = 0; i < netlist.size(); i++)
+        {
+            if (!netlist.isAlive(i))
+                continue;
+            SDL_FPoint p = camera.toScreen(netlist.x(i), netlist.y(i));
+            heatMap.add(p.x, p.y, frame.state(i));
+        }
+        heatMap.draw();
+        renderOverlay();
+        return;
     }
-    for(int y=0;y<SCREEN_HEIGHT;y+=GRID_SIZE){
-        SDL_RenderLine(renderer,0,y,SCREEN_WIDTH,y);
+    //mid range: plain rects, no pins, borders or labels
+    const bool simple = camera.zoom < LOD_SIMPLE_ZOOM;
+
+    //what the camera sees, in world coordinates, shapes are mapped to the screen by the batch
+    SDL_FRect viewRect = camera.visible((float)viewWidth, (float)viewHeight);
+    batch.setView(camera.x, camera.y, camera.zoom);
+    labels.setView(camera.x, camera.y, camera.zoom);
+
+    //the components around the view, the margin reaches the readers of the short wires that cross it
+    //(their boxes hold the pins), sorted by id so they draw in the same order pick() tests them
+    nearby.clear();
+    spatialIndex.queryRect(viewRect.x - LONG_WIRE_LENGTH, viewRect.y - LONG_WIRE_LENGTH,
+                           viewRect.x + viewRect.w + LONG_WIRE_LENGTH, viewRect.y + viewRect.h + LONG_WIRE_LENGTH,
+                           [&](int id) { nearby.push_back(id); });
+    std::sort(nearby.begin(), nearby.end());
+
+    //the component being dragged draws all of its wires itself, the long wire list is only
+    //brought up to date when it is dropped
+    Component* selectedView = view(selected);
+    Component* dragged = selectedView && selectedView->isDragging ? selectedView : nullptr;
+    auto touchesDragged = [&](int reader, int src) {
+        return dragged && (reader == dragged->netId || src == dragged->netId);
+    };
+
+    //every shape of the scene goes into one batch, drawn with a single call
+    //first the wires, colored by the driving node, so the gates cover their ends
+    auto drawWire = [&](int src, SDL_FPoint from, SDL_FPoint to) {
+        if (!segmentIntersectsRect(from.x, from.y, to.x, to.y, viewRect))
+            return;
+        SDL_Color color = frame.state(src) ? SDL_Color{0, 255, 0, 255} : SDL_Color{100, 0, 0, 255};
+        //buses are thicker, high means any bit is set
+        batch.line(from.x, from.y, to.x, to.y, color, netlist.outputWidth(src) > 1 ? 3.0f : 1.0f);
+    };
+    for (int id : nearby)
+    {
+        Component *comp = components[id];
+        for (int port = 0; port < comp->numInputs(); port++)
+        {
+            int src = netlist.input(id, port);
+            if (src < 0 || touchesDragged(id, src))
+                continue;
+            SDL_FPoint from = components[src]->outputPin();
+            SDL_FPoint to = comp->inputPin(port);
+            if (!isLongWire(from, to))
+                drawWire(src, from, to);
+        }
+    }
+    for (const WireRef& wire : longWires)
+    {
+        int src = netlist.input(wire.node, wire.port);
+        if (src < 0 || touchesDragged(wire.node, src))
+            continue;
+        drawWire(src, components[src]->outputPin(), components[wire.node]->inputPin(wire.port));
+    }
+    if (dragged)
+    {
+        for (int port = 0; port < dragged->numInputs(); port++)
+        {
+            int src = netlist.input(dragged->netId, port);
+            if (src >= 0)
+                drawWire(src, components[src]->outputPin(), dragged->inputPin(port));
+        }
+        netlist.forEachReader(dragged->netId, [&](int reader, int port) {
+            drawWire(dragged->netId, dragged->outputPin(), components[reader]->inputPin(port));
+        });
     }
 
-    for (Component *comp : components)
+    //then the bodies of the components on screen, the margin keeps the pins and the label
+    auto onScreen = [&](const Component* comp) {
+        return comp->x + comp->width + 10 >= viewRect.x && comp->x - 10 <= viewRect.x + viewRect.w &&
+               comp->y + comp->height + 10 >= viewRect.y && comp->y - 40 <= viewRect.y + viewRect.h;
+    };
+    for (int id : nearby)
     {
-        comp->draw(renderer);
-        comp->drawLabel(renderer);
+        Component *comp = components[id];
+        if (!onScreen(comp))
+            continue;
+        if (simple)
+            comp->drawSimple(batch, frame.state(comp->netId));
+        else
+            comp->draw(batch, frame.state(comp->netId));
+
+        //on a loop that doesn't settle, its state is whatever the last sweep left
+        if (frame.oscillating(comp->netId))
+        {
+            SDL_FRect loopRect = {comp->x - 2, comp->y - 2, (float)comp->width + 4, (float)comp->height + 4};
+            batch.rect(loopRect, {255, 150, 0, 255});
+        }
 
         //draw selection box
-        if (comp == selectedComponent)
+        if (comp == selectedView)
         {
-            SDL_SetRenderDrawColor(renderer, 255, 255, 0, 255);
             SDL_FRect selRect = {comp->x - 3, comp->y - 3, (float)comp->width + 6, (float)comp->height + 6};
-            SDL_RenderRect(renderer, &selRect);
+            batch.rect(selRect, {255, 255, 0, 255});
         }
     }
 
     //draw wiring line
+    Component* wiringSource = view(wiringFrom);
     if (isWiring && wiringSource)
     {
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-        SDL_RenderLine(renderer, wiringSource->x + wiringSource->width, wiringSource->y + wiringSource->height / 2, mouseX, mouseY);
+        SDL_FPoint from = wiringSource->outputPin();
+        batch.line(from.x, from.y, mouseX, mouseY, {255, 255, 255, 255});
+    }
+    batch.flush(renderer);
+
+    //labels are textures, they go on top of the geometry
+    if (!simple)
+    {
+        for (int id : nearby)
+        {
+            if (onScreen(components[id]))
+                components[id]->drawLabel(labels);
+        }
+        labels.flush();
     }
+    renderOverlay();
+}
+
+// @brief
+// the imgui windows on top of the frame, then presents it
+void Application::renderOverlay()
+{
     //redner the imgui on top
     ImGui::Render();
     ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), renderer);
     SDL_RenderPresent(renderer);
 }
 
-void Application::cleanup()
+// @brief
+// draws the grid lines of one tile into a target texture
+// the tile starts with a line on its top and left edge so repeating it continues the grid
+void Application::buildGridTexture()
 {
-    //delete all components
-    for (Component *comp : components)
+    if (gridTexture)
+        SDL_DestroyTexture(gridTexture);
+    gridTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                    GRID_TILE_SIZE, GRID_TILE_SIZE);
+    if (!gridTexture)
+        return; //no target textures, drawGrid() falls back to lines
+
+    //nearest so the 1px lines stay sharp when the logical presentation scales
+    SDL_SetTextureScaleMode(gridTexture, SDL_SCALEMODE_NEAREST);
+    SDL_SetTextureBlendMode(gridTexture, SDL_BLENDMODE_NONE);
+
+    //logical presentation is per target, the tile is drawn in its own pixels
+    SDL_SetRenderTarget(renderer, gridTexture);
+
+    SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, 70, 70, 70, 255);
+    for (int k = 0; k < GRID_TILE_SIZE; k += GRID_SIZE)
+    {
+        SDL_RenderLine(renderer, k, 0, k, GRID_TILE_SIZE);
+        SDL_RenderLine(renderer, 0, k, GRID_TILE_SIZE, k);
+    }
+
+    SDL_SetRenderTarget(renderer, nullptr);
+}
+
+// @brief
+// background grid under the camera, the tile is scaled by the zoom and shifted by the pan
+void Application::drawGrid()
+{
+    //too dense to tell the lines apart, the background alone is enough
+    const float step = GRID_SIZE * camera.zoom;
+    if (step < 4)
+        return;
+    if (gridTexture)
     {
-        delete comp;
+        //start one tile before the screen so the pan offset never shows a gap
+        const float tile = GRID_TILE_SIZE * camera.zoom;
+        float offsetX = std::fmod(camera.x * camera.zoom, tile);
+        float offsetY = std::fmod(camera.y * camera.zoom, tile);
+        if (offsetX < 0) offsetX += tile;
+        if (offsetY < 0) offsetY += tile;
+        SDL_FRect area = {-offsetX, -offsetY, viewWidth + tile, viewHeight + tile};
+        SDL_RenderTextureTiled(renderer, gridTexture, nullptr, camera.zoom, &area);
+        return;
     }
+
+    SDL_SetRenderDrawColor(renderer, 70, 70, 70, 255);
+    SDL_FPoint first = camera.toScreen(std::floor(camera.x / GRID_SIZE) * GRID_SIZE,
+                                       std::floor(camera.y / GRID_SIZE) * GRID_SIZE);
+    for (float x = first.x; x < viewWidth; x += step)
+    {
+        SDL_RenderLine(renderer, x, 0, x, viewHeight);
+    }
+    for (float y = first.y; y < viewHeight; y += step)
+    {
+        SDL_RenderLine(renderer, 0, y, viewWidth, y);
+    }
+}
+
+void Application::cleanup()
+{
+    //the worker calls back into the application, stop it first
+    simWorker.stop();
+    //drop all components
+    componentPool.reset();
     components.clear();
+    netlist.clear();
+    spatialIndex.clear();
     ImGui_ImplSDLRenderer3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
     //destroy sdl objects
+    if (gridTexture)
+        SDL_DestroyTexture(gridTexture);
+    labels.clear();
+    heatMap.clear();
     if (font)
         TTF_CloseFont(font);
     if (renderer)
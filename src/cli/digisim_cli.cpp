@@ -0,0 +1,225 @@
+// headless front end of the simulation core, no SDL involved
+// usage: digisim_cli <circuit.json|circuit.dsim> [-n cycles] [-s switch=0|1]... [-t] [-j threads] [-o out.json|out.dsim [-c]]
+#include <netlist.hpp>
+#include <simulator.hpp>
+#include <batch_simulator.hpp>
+#include <circuit_io.hpp>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+static void printUsage()
+{
+    std::printf("usage: digisim_cli <circuit.json|circuit.dsim> [options]\n"
+                "  -n, --cycles N        full evaluation passes to run, clock cycles for a sequential circuit (default 1)\n"
+                "  -s, --set K=V         drive the K-th switch (file order, from 0) to V (0x.. for hex)\n"
+                "  -t, --truth-table     print the outputs for every input combination\n"
+                "  -j, --threads N       evaluate wide levels on N threads (default 1)\n"
+                "  -o, --output FILE     write the circuit to FILE, binary if it ends in .dsim\n"
+                "  -c, --compact         no indentation in the written json\n");
+}
+
+// @brief
+// reads a K=V switch setting, V is decimal or 0x.. hex and is cut to the width of the switch
+// false if either side is not a whole number
+static bool parseDrive(const std::string& spec, std::pair<int, uint64_t>& drive)
+{
+    size_t eq = spec.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 == spec.size() || spec[eq + 1] == '-')
+        return false;
+    const char* key = spec.c_str();
+    const char* value = key + eq + 1;
+    char* end = nullptr;
+    errno = 0;
+    long k = std::strtol(key, &end, 10);
+    if (end != value - 1 || k < 0 || k > INT32_MAX)
+        return false;
+    unsigned long long v = std::strtoull(value, &end, 0);
+    if (*end != '\0' || errno == ERANGE)
+        return false;
+    drive = {(int)k, (uint64_t)v};
+    return true;
+}
+
+// @brief
+// prints one row per input pattern, evaluated 64 patterns at a time
+static void printTruthTable(const Program& program)
+{
+    if (program.wide)
+    {
+        std::fprintf(stderr, "truth tables need a circuit without buses\n");
+        return;
+    }
+    if (program.sequential())
+    {
+        std::fprintf(stderr, "truth tables need a circuit without registers or clocks\n");
+        return;
+    }
+    BatchSimulator<Lanes64> batch(program);
+    const int inputs = batch.inputCount();
+    const int outputs = batch.outputCount();
+
+    std::string row(inputs + 3 + outputs, ' ');
+    row[inputs + 1] = '|';
+    bool ran = batch.exhaustive([&](uint64_t first, int lanes) {
+        for (int j = 0; j < lanes; j++)
+        {
+            uint64_t pattern = first + j;
+            //switch 0 is the leftmost column
+            for (int k = 0; k < inputs; k++)
+                row[k] = ((pattern >> k) & 1) ? '1' : '0';
+            for (int k = 0; k < outputs; k++)
+                row[inputs + 3 + k] = Lanes<Lanes64>::get(batch.output(k), j) ? '1' : '0';
+            std::puts(row.c_str());
+        }
+    });
+    if (!ran)
+        std::fprintf(stderr, "too many switches for a truth table (%d, at most %d)\n", inputs, EXHAUSTIVE_MAX_INPUTS);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string path;
+    long long cycles = 1;
+    bool truthTable = false;
+    int threads = 1;
+    std::string outputPath;
+    bool compact = false;
+    std::vector<std::pair<int, uint64_t>> drives;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-n" || arg == "--cycles") && i + 1 < argc)
+        {
+            cycles = std::atoll(argv[++i]);
+        }
+        else if ((arg == "-s" || arg == "--set") && i + 1 < argc)
+        {
+            std::pair<int, uint64_t> drive;
+            if (!parseDrive(argv[++i], drive))
+            {
+                std::fprintf(stderr, "bad switch setting: %s\n", argv[i]);
+                printUsage();
+                return 1;
+            }
+            drives.push_back(drive);
+        }
+        else if ((arg == "-j" || arg == "--threads") && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "-t" || arg == "--truth-table")
+        {
+            truthTable = true;
+        }
+        else if ((arg == "-o" || arg == "--output") && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+        else if (arg == "-c" || arg == "--compact")
+        {
+            compact = true;
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (path.empty() && arg[0] != '-')
+        {
+            path = arg;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Netlist netlist;
+    auto loadStart = std::chrono::steady_clock::now();
+    if (!loadCircuitFile(netlist, path))
+    {
+        std::fprintf(stderr, "Failed to load: %s\n", path.c_str());
+        return 1;
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    std::fprintf(stderr, "Loaded: %s (%.3f ms)\n", path.c_str(), loadSeconds * 1000.0);
+
+    if (!outputPath.empty())
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (!saveCircuitFile(netlist, outputPath, compact))
+        {
+            std::fprintf(stderr, "Failed to write: %s\n", outputPath.c_str());
+            return 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "Saved to: %s (%.3f ms)\n", outputPath.c_str(), seconds * 1000.0);
+    }
+
+    Simulator simulator;
+    simulator.setThreadCount(threads);
+    simulator.compile(netlist);
+    const Program& program = simulator.getProgram();
+
+    if (truthTable)
+    {
+        printTruthTable(program);
+        return 0;
+    }
+
+    for (const auto& drive : drives)
+    {
+        if (drive.first < 0 || drive.first >= (int)program.sources.size())
+        {
+            std::fprintf(stderr, "no switch %d\n", drive.first);
+            return 1;
+        }
+        simulator.setSource(program.sources[drive.first], drive.second);
+    }
+
+    //a sequential circuit settles once from its switches, then every cycle is one clock edge pair
+    auto start = std::chrono::steady_clock::now();
+    if (program.sequential())
+    {
+        simulator.evaluate();
+        for (long long c = 0; c < cycles; c++)
+        {
+            simulator.step();
+        }
+    }
+    else
+    {
+        for (long long c = 0; c < cycles; c++)
+        {
+            simulator.evaluate();
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (size_t k = 0; k < program.probes.size(); k++)
+    {
+        std::printf("light %zu: %llu\n", k, (unsigned long long)simulator.word(program.probes[k]));
+    }
+    if (simulator.oscillatingCount() > 0)
+    {
+        std::fprintf(stderr, "warning: %d of %d loops did not settle\n", simulator.oscillatingCount(),
+                     simulator.loopCount());
+    }
+    std::fprintf(stderr, "%d nodes, %d gates, %d registers, %d levels, %d loops, %lld cycles in %.3f ms (%d threads)\n",
+                 netlist.size(), simulator.gateCount(), simulator.registerCount(), simulator.levelCount(),
+                 simulator.loopCount(), cycles, seconds * 1000.0, simulator.threadCount());
+    return 0;
+}
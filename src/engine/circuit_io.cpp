@@ -0,0 +1,540 @@
+#include <circuit_io.hpp>
+#include <mapped_file.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+// @brief
+// buffered record writer, the file is filled in large chunks and never held in memory whole
+class JsonStream{
+    public:
+        JsonStream(std::ofstream& file, bool compact) : file(file), compact(compact) {
+            buffer.reserve(FLUSH_SIZE + 256);
+        }
+        ~JsonStream() { flush(); }
+
+        void raw(const char* text) { buffer += text; }
+
+        // @brief
+        // starts a new line at the given depth, compact mode keeps the line but not the indentation
+        void newline(int depth){
+            buffer += '\n';
+            if (!compact) buffer.append(depth * 4, ' ');
+        }
+
+        void key(const char* name){
+            buffer += '"';
+            buffer += name;
+            buffer += compact ? "\":" : "\": ";
+        }
+
+        void value(int v){
+            char text[16];
+            auto res = std::to_chars(text, text + sizeof(text), v);
+            buffer.append(text, res.ptr);
+        }
+
+        void value(float v){
+            char text[32];
+            auto res = std::to_chars(text, text + sizeof(text), v); //shortest form that reads back exactly
+            buffer.append(text, res.ptr);
+        }
+
+        void value(const char* v){
+            buffer += '"';
+            buffer += v;
+            buffer += '"';
+        }
+
+        void endRecord(){
+            if (buffer.size() >= FLUSH_SIZE) flush();
+        }
+
+        void flush(){
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+
+    private:
+        static constexpr size_t FLUSH_SIZE = 1 << 16;
+        std::ofstream& file;
+        bool compact;
+        std::string buffer;
+};
+
+bool saveCircuitJson(const Netlist& netlist, const std::string& filename, bool compact)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    //removed nodes leave holes, the file ids are dense
+    std::vector<int> fileIndex(netlist.size(), -1);
+    int count = 0;
+    for (int i = 0; i < netlist.size(); i++)
+    {
+        if (netlist.isAlive(i)) fileIndex[i] = count++;
+    }
+
+    JsonStream out(file, compact);
+    const char* separator = compact ? "," : ", ";
+    out.raw("[");
+
+    //one record per node, the id is the index in the array
+    bool first = true;
+    for (int i = 0; i < netlist.size(); i++)
+    {
+        if (!netlist.isAlive(i))
+            continue;
+        GateType type = netlist.type(i);
+
+        if (!first) out.raw(",");
+        first = false;
+        out.newline(1);
+        out.raw("{");
+
+        out.key("id");
+        out.value(fileIndex[i]);
+        out.raw(separator);
+        out.key("type");
+        out.value(gateTypeName(type));
+        out.raw(separator);
+        out.key("x");
+        out.value(netlist.x(i));
+        out.raw(separator);
+        out.key("y");
+        out.value(netlist.y(i));
+        if (netlist.width(i) > 1)
+        {
+            out.raw(separator);
+            out.key("width");
+            out.value(netlist.width(i));
+        }
+
+        for (int p = 0; p < netlist.inputCount(i); p++)
+        {
+            int src = netlist.input(i, p);
+            out.raw(separator);
+            if (p < gateInfo(type).inputs) out.key(gateInfo(type).portKeys[p]);
+            else out.key(gatePortKey(type, p).c_str());
+            out.value(src >= 0 ? fileIndex[src] : -1);
+        }
+
+        out.raw("}");
+        out.endRecord();
+    }
+
+    out.newline(0);
+    out.raw("]");
+    out.flush();
+    return file.good();
+}
+
+// @brief
+// sax handler of loadCircuitJson, builds the nodes while the file is read and never holds a DOM
+// the document is an array of flat records, whatever is nested deeper is skipped
+// wires can point forward in the file, so they wait in a pending list until every node exists
+class CircuitSaxHandler : public nlohmann::json_sax<json>{
+    public:
+        explicit CircuitSaxHandler(Netlist& netlist) : netlist(netlist) {}
+
+        struct PendingWire{
+            int node;
+            int port;
+            int source; //file index
+        };
+
+        std::vector<int> nodeOf; //file index -> node index, -1 for skipped records
+        std::vector<PendingWire> wires;
+        bool valid = false; //the document was an array
+
+        bool null() override { return scalar(); }
+        bool boolean(bool) override { return scalar(); }
+        bool number_integer(number_integer_t v) override { return number((double)v); }
+        bool number_unsigned(number_unsigned_t v) override { return number((double)v); }
+        bool number_float(number_float_t v, const string_t&) override { return number(v); }
+        bool binary(binary_t&) override { return scalar(); }
+
+        bool string(string_t& v) override {
+            if (depth == 2 && field == FIELD_TYPE)
+                record.known = gateTypeFromName(v, record.type);
+            return scalar();
+        }
+
+        bool key(string_t& name) override {
+            if (depth != 2) return true;
+            if (name == "type") field = FIELD_TYPE;
+            else if (name == "x") field = FIELD_X;
+            else if (name == "y") field = FIELD_Y;
+            else if (name == "width") field = FIELD_WIDTH;
+            else if ((port = gatePortFromKey(name)) >= 0){
+                field = FIELD_PORT;
+                if (port + 1 > record.portCount) record.portCount = port + 1;
+            }
+            else field = FIELD_OTHER;
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            if (depth == 1) record = Record();
+            depth++;
+            return true;
+        }
+
+        bool end_object() override {
+            depth--;
+            if (depth == 1) endRecord();
+            return true;
+        }
+
+        bool start_array(std::size_t) override {
+            if (depth == 0) valid = true;
+            else if (depth == 1) nodeOf.push_back(-1);
+            depth++;
+            return depth > 1 || valid;
+        }
+
+        bool end_array() override {
+            depth--;
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+            return false;
+        }
+
+    private:
+        enum Field{ FIELD_OTHER, FIELD_TYPE, FIELD_X, FIELD_Y, FIELD_WIDTH, FIELD_PORT };
+
+        struct Record{
+            bool known = false;
+            GateType type = GATE_SWITCH;
+            float x = 0.0f;
+            float y = 0.0f;
+            int width = 1;
+            int portCount = 0; //one past the highest port key, the input count of an n-input gate
+            int ports[MAX_FANIN];
+
+            Record() { std::fill(ports, ports + MAX_FANIN, -1); }
+        };
+
+        Netlist& netlist;
+        int depth = 0;
+        Field field = FIELD_OTHER;
+        int port = -1; //input port of the FIELD_PORT key
+        Record record;
+
+        bool scalar(){
+            if (depth == 1) nodeOf.push_back(-1); //not a record, it still takes a file index
+            return valid || depth > 0;
+        }
+
+        bool number(double v){
+            if (depth == 2){
+                //anything that doesn't fit the field fails the load before it is cast:
+                //widths and ports are whole ints (not 1.5 or 1e30), a bus wider than a
+                //machine word can't be simulated, and positions have to fit a float
+                const bool whole = v == std::floor(v) && v >= INT32_MIN && v <= INT32_MAX;
+                switch (field){
+                    case FIELD_X:
+                    case FIELD_Y:
+                        if (!(std::fabs(v) <= FLT_MAX)) return false;
+                        (field == FIELD_X ? record.x : record.y) = (float)v;
+                        break;
+                    case FIELD_WIDTH:
+                        if (!whole || v < 1 || v > MAX_WIDTH) return false;
+                        record.width = (int)v;
+                        break;
+                    case FIELD_PORT:
+                        if (!whole) return false;
+                        record.ports[port] = (int)v;
+                        break;
+                    default: break;
+                }
+            }
+            return scalar();
+        }
+
+        void endRecord(){
+            if (!record.known){
+                nodeOf.push_back(-1);
+                return;
+            }
+            int node = netlist.add(record.type, record.x, record.y, record.width, record.portCount);
+            nodeOf.push_back(node);
+            for (int p = 0; p < netlist.inputCount(node); p++){
+                if (record.ports[p] >= 0) wires.push_back({node, p, record.ports[p]});
+            }
+        }
+};
+
+bool loadCircuitJson(Netlist& netlist, const std::string& filename)
+{
+    MappedFile file;
+    if (!file.open(filename))
+        return false;
+
+    Netlist loaded;
+    CircuitSaxHandler handler(loaded);
+    const char* text = (const char*)file.data();
+    if (!json::sax_parse(text, text + file.size(), &handler) || !handler.valid)
+        return false;
+
+    //reconnect wires, every node exists by now
+    for (const auto& wire : handler.wires)
+    {
+        if (wire.source < (int)handler.nodeOf.size())
+            loaded.connect(wire.node, wire.port, handler.nodeOf[wire.source]);
+    }
+
+    netlist = std::move(loaded);
+    return true;
+}
+
+// @brief
+// layout of the binary format, every field is little endian
+// offsets let a later version append sections without moving the old ones
+struct BinaryHeader{
+    char magic[4];         //"DSIM"
+    uint16_t version;
+    uint16_t headerSize;   //sizeof(BinaryHeader) of the writer
+    uint32_t nodeCount;
+    uint32_t inputCount;   //entries of the input table
+    uint64_t nodesOffset;  //from the start of the file
+    uint64_t inputsOffset;
+    uint32_t byteOrder;    //BINARY_BYTE_ORDER as the writer stored it
+    uint32_t reserved;
+};
+
+struct BinaryNode{
+    uint8_t type;
+    uint8_t inputCount;
+    uint8_t width;         //bus width, version 1 files have 0 here and only single bits
+    uint8_t reserved;
+    float x;
+    float y;
+    uint32_t firstInput;   //index in the input table
+};
+
+static_assert(sizeof(BinaryHeader) == 40, "binary header layout");
+static_assert(sizeof(BinaryNode) == 16, "binary node layout");
+
+static const char BINARY_MAGIC[4] = {'D', 'S', 'I', 'M'};
+static const uint32_t BINARY_BYTE_ORDER = 0x01020304;
+
+// @brief
+// the records are written as they sit in memory, which is the file's byte order on a little
+// endian host; a big endian one swaps every field on the way in and out
+static bool hostIsLittleEndian()
+{
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+template<typename T>
+static void swapBytes(T& v)
+{
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &v, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&v, bytes, sizeof(T));
+}
+
+//swapping is its own inverse, the same call turns a host record into a file one and back
+static void swapHeader(BinaryHeader& h)
+{
+    swapBytes(h.version);
+    swapBytes(h.headerSize);
+    swapBytes(h.nodeCount);
+    swapBytes(h.inputCount);
+    swapBytes(h.nodesOffset);
+    swapBytes(h.inputsOffset);
+    swapBytes(h.byteOrder);
+    swapBytes(h.reserved);
+}
+
+static void swapNode(BinaryNode& n)
+{
+    swapBytes(n.x);
+    swapBytes(n.y);
+    swapBytes(n.firstInput);
+}
+
+bool saveCircuitBinary(const Netlist& netlist, const std::string& filename)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    std::vector<int> fileIndex(netlist.size(), -1);
+    uint32_t nodeCount = 0;
+    uint32_t inputCount = 0;
+    for (int i = 0; i < netlist.size(); i++)
+    {
+        if (!netlist.isAlive(i))
+            continue;
+        fileIndex[i] = nodeCount++;
+        inputCount += netlist.inputCount(i);
+    }
+
+    BinaryHeader header = {};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = CIRCUIT_BINARY_VERSION;
+    header.headerSize = sizeof(BinaryHeader);
+    header.nodeCount = nodeCount;
+    header.inputCount = inputCount;
+    header.nodesOffset = sizeof(BinaryHeader);
+    header.inputsOffset = header.nodesOffset + (uint64_t)nodeCount * sizeof(BinaryNode);
+    header.byteOrder = BINARY_BYTE_ORDER;
+    const bool swap = !hostIsLittleEndian();
+    if (swap) swapHeader(header);
+    file.write((const char*)&header, sizeof(header));
+
+    //both sections go out in blocks, the file is never built in memory
+    const size_t BLOCK = 4096;
+    std::vector<BinaryNode> nodes;
+    nodes.reserve(BLOCK);
+    uint32_t firstInput = 0;
+    for (int i = 0; i < netlist.size(); i++)
+    {
+        if (!netlist.isAlive(i))
+            continue;
+        BinaryNode node = {};
+        node.type = netlist.type(i);
+        node.inputCount = (uint8_t)netlist.inputCount(i);
+        node.width = (uint8_t)netlist.width(i);
+        node.x = netlist.x(i);
+        node.y = netlist.y(i);
+        node.firstInput = firstInput;
+        firstInput += node.inputCount;
+        if (swap) swapNode(node);
+        nodes.push_back(node);
+        if (nodes.size() == BLOCK)
+        {
+            file.write((const char*)nodes.data(), nodes.size() * sizeof(BinaryNode));
+            nodes.clear();
+        }
+    }
+    file.write((const char*)nodes.data(), nodes.size() * sizeof(BinaryNode));
+
+    std::vector<int32_t> inputs;
+    inputs.reserve(BLOCK);
+    for (int i = 0; i < netlist.size(); i++)
+    {
+        if (!netlist.isAlive(i))
+            continue;
+        for (int p = 0; p < netlist.inputCount(i); p++)
+        {
+            int src = netlist.input(i, p);
+            int32_t entry = src >= 0 ? fileIndex[src] : -1;
+            if (swap) swapBytes(entry);
+            inputs.push_back(entry);
+        }
+        if (inputs.size() >= BLOCK)
+        {
+            file.write((const char*)inputs.data(), inputs.size() * sizeof(int32_t));
+            inputs.clear();
+        }
+    }
+    file.write((const char*)inputs.data(), inputs.size() * sizeof(int32_t));
+    return file.good();
+}
+
+bool loadCircuitBinary(Netlist& netlist, const std::string& filename)
+{
+    MappedFile file;
+    if (!file.open(filename) || file.size() < sizeof(BinaryHeader))
+        return false;
+    const uint8_t* base = file.data();
+
+    BinaryHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const bool swap = !hostIsLittleEndian();
+    if (swap) swapHeader(header);
+    if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0
+        || header.version == 0 || header.version > CIRCUIT_BINARY_VERSION
+        || header.byteOrder != BINARY_BYTE_ORDER
+        || header.headerSize < sizeof(BinaryHeader))
+        return false;
+
+    //every section has to lie inside the file, the counts are not trusted
+    const uint64_t size = file.size();
+    if (header.nodesOffset > size || header.inputsOffset > size
+        || (uint64_t)header.nodeCount * sizeof(BinaryNode) > size - header.nodesOffset
+        || (uint64_t)header.inputCount * sizeof(int32_t) > size - header.inputsOffset)
+        return false;
+
+    const uint8_t* nodeBytes = base + header.nodesOffset;
+    const uint8_t* inputBytes = base + header.inputsOffset;
+
+    Netlist loaded;
+    loaded.reserve(header.nodeCount, header.inputCount);
+    std::vector<int> nodeOf(header.nodeCount, -1);
+
+    //create nodes (no wiring)
+    for (uint32_t i = 0; i < header.nodeCount; i++)
+    {
+        BinaryNode node;
+        std::memcpy(&node, nodeBytes + (size_t)i * sizeof(BinaryNode), sizeof(node));
+        if (swap) swapNode(node);
+        if (node.width > MAX_WIDTH)
+            return false;
+        if (node.type >= GATE_TYPE_COUNT)
+            continue;
+        nodeOf[i] = loaded.add((GateType)node.type, node.x, node.y, node.width > 0 ? node.width : 1, node.inputCount);
+    }
+
+    //reconnect wires
+    for (uint32_t i = 0; i < header.nodeCount; i++)
+    {
+        int target = nodeOf[i];
+        if (target < 0)
+            continue;
+        BinaryNode node;
+        std::memcpy(&node, nodeBytes + (size_t)i * sizeof(BinaryNode), sizeof(node));
+        if (swap) swapNode(node);
+        if ((uint64_t)node.firstInput + node.inputCount > header.inputCount)
+            continue;
+        int ports = std::min<int>(node.inputCount, loaded.inputCount(target));
+        for (int p = 0; p < ports; p++)
+        {
+            int32_t src;
+            std::memcpy(&src, inputBytes + ((size_t)node.firstInput + p) * sizeof(int32_t), sizeof(src));
+            if (swap) swapBytes(src);
+            if (src >= 0 && (uint32_t)src < header.nodeCount)
+                loaded.connect(target, p, nodeOf[src]);
+        }
+    }
+
+    netlist = std::move(loaded);
+    return true;
+}
+
+static bool isBinaryPath(const std::string& filename)
+{
+    const std::string ext = ".dsim";
+    return filename.size() >= ext.size()
+        && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+bool saveCircuitFile(const Netlist& netlist, const std::string& filename, bool compact)
+{
+    if (isBinaryPath(filename))
+        return saveCircuitBinary(netlist, filename);
+    return saveCircuitJson(netlist, filename, compact);
+}
+
+bool loadCircuitFile(Netlist& netlist, const std::string& filename)
+{
+    if (isBinaryPath(filename))
+        return loadCircuitBinary(netlist, filename);
+    return loadCircuitJson(netlist, filename);
+}
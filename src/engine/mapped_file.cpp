@@ -0,0 +1,96 @@
+#include <mapped_file.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        close();
+        return false;
+    }
+    length = (size_t)fileSize.QuadPart;
+    if (length == 0)
+        return true; //an empty file can't be mapped, but it is a valid (empty) file
+
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+    {
+        close();
+        return false;
+    }
+    bytes = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!bytes)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (bytes) UnmapViewOfFile(bytes);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    bytes = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+    length = 0;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string& filename)
+{
+    close();
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close();
+        return false;
+    }
+    length = (size_t)info.st_size;
+    if (length == 0)
+        return true; //an empty file can't be mapped, but it is a valid (empty) file
+
+    void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    //the records are read front to back exactly once
+    madvise(view, length, MADV_SEQUENTIAL);
+    bytes = (const uint8_t*)view;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (bytes) munmap((void*)bytes, length);
+    if (fd >= 0) ::close(fd);
+    bytes = nullptr;
+    fd = -1;
+    length = 0;
+}
+#endif
@@ -0,0 +1,304 @@
+#include <netlist.hpp>
+#include <atomic>
+
+//one row per GateType, in enum order
+//a key names the same port in every type that has it ("clk" is always port 1), files don't
+//have to list the type before the wires
+static const GateInfo GATE_INFO[GATE_TYPE_COUNT] = {
+    {"SWITCH",  0, false, true,  false, false, 0, {nullptr, nullptr, nullptr}},
+    {"LIGHT",   1, false, false, false, false, 0, {"src", nullptr, nullptr}},
+    {"AND",     2, true,  true,  false, false, 0, {"in1", "in2", nullptr}},
+    {"OR",      2, true,  true,  false, false, 0, {"in1", "in2", nullptr}},
+    {"NOT",     1, false, true,  false, false, 0, {"src", nullptr, nullptr}},
+    {"XOR",     2, true,  true,  false, false, 0, {"in1", "in2", nullptr}},   //odd parity with more inputs
+    {"ADD",     2, false, true,  false, false, 0, {"in1", "in2", nullptr}},
+    {"MUX",     3, false, true,  false, false, 4, {"in1", "in2", "sel"}},     //in1 when sel is low, in2 when high
+    {"EQ",      2, false, true,  true,  false, 0, {"in1", "in2", nullptr}},
+    {"LT",      2, false, true,  true,  false, 0, {"in1", "in2", nullptr}},   //unsigned in1 < in2
+    {"NAND",    2, true,  true,  false, false, 0, {"in1", "in2", nullptr}},
+    {"NOR",     2, true,  true,  false, false, 0, {"in1", "in2", nullptr}},
+    {"XNOR",    2, true,  true,  false, false, 0, {"in1", "in2", nullptr}},
+    {"DFF",     2, false, true,  false, true,  2, {"d", "clk", nullptr}},
+    {"REG",     3, false, true,  false, true,  6, {"d", "clk", "en"}},
+    {"COUNTER", 3, false, true,  false, true,  7, {"reset", "clk", "en"}},
+    {"CLOCK",   0, false, true,  false, false, 0, {nullptr, nullptr, nullptr}},
+};
+
+static const GateInfo NO_GATE = {"", 0, false, false, false, false, 0, {nullptr, nullptr, nullptr}};
+
+const GateInfo& gateInfo(GateType type)
+{
+    return type < GATE_TYPE_COUNT ? GATE_INFO[type] : NO_GATE;
+}
+
+int gatePortFromKey(const std::string& key)
+{
+    for (const GateInfo& info : GATE_INFO)
+    {
+        for (int p = 0; p < info.inputs; p++)
+        {
+            if (key == info.portKeys[p]) return p;
+        }
+    }
+    //the unnamed ports of the n-input gates
+    if (key.size() > 2 && key.compare(0, 2, "in") == 0 && key.find_first_not_of("0123456789", 2) == std::string::npos)
+    {
+        int n = key.size() < 5 ? std::stoi(key.substr(2)) : 0;
+        if (n >= 1 && n <= MAX_FANIN) return n - 1;
+    }
+    return -1;
+}
+
+std::string gatePortKey(GateType type, int port)
+{
+    const GateInfo& info = gateInfo(type);
+    if (port < info.inputs && port < MAX_INPUTS) return info.portKeys[port];
+    return "in" + std::to_string(port + 1);
+}
+
+const char* gateTypeName(GateType type)
+{
+    return gateInfo(type).name;
+}
+
+bool gateTypeFromName(const std::string& name, GateType& type)
+{
+    for (int t = 0; t < GATE_TYPE_COUNT; t++)
+    {
+        if (name == GATE_INFO[t].name)
+        {
+            type = (GateType)t;
+            return true;
+        }
+    }
+    return false;
+}
+
+int gateInputCount(GateType type)
+{
+    return gateInfo(type).inputs;
+}
+
+// @brief
+// generations are unique across every netlist (the editor's and the simulation thread's copy
+// add nodes concurrently), 0 is never handed out
+static uint32_t newGeneration()
+{
+    static std::atomic<uint32_t> counter{0};
+    uint32_t generation = counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    return generation != 0 ? generation : counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+int Netlist::clampInputs(GateType type, int count) const
+{
+    const GateInfo& info = gateInfo(type);
+    if (!info.variadic || count <= 0) return info.inputs;
+    return count < 2 ? 2 : count > MAX_FANIN ? MAX_FANIN : count;
+}
+
+// @brief
+// gives the node a new range of count open slots at the end of the slot arrays
+// the slots of its old range stay behind unused until the next clear()
+void Netlist::allocateInputs(int node, int count)
+{
+    for (int p = 0; p < inputCapacity[node]; p++)
+    {
+        slotNode[inputStart[node] + p] = -1;
+    }
+    inputStart[node] = (int32_t)inputs.size();
+    inputCapacity[node] = (uint8_t)count;
+    inputs.insert(inputs.end(), count, -1);
+    slotNode.insert(slotNode.end(), count, node);
+    nextReader.insert(nextReader.end(), count, -1);
+    prevReader.insert(prevReader.end(), count, -1);
+}
+
+int Netlist::add(GateType type, float x, float y, int width, int ports)
+{
+    width = width < 1 ? 1 : width > MAX_WIDTH ? MAX_WIDTH : width;
+    ports = clampInputs(type, ports);
+    if (!freeNodes.empty())
+    {
+        //a removed node has no wires left, only its own data needs resetting
+        //its slots are reused if they are enough
+        int node = freeNodes.back();
+        freeNodes.pop_back();
+        types[node] = type;
+        values[node] = 0;
+        widths[node] = (uint8_t)width;
+        if (ports > inputCapacity[node]) allocateInputs(node, ports);
+        inputCounts[node] = (uint8_t)ports;
+        posX[node] = x;
+        posY[node] = y;
+        generations[node] = newGeneration();
+        return node;
+    }
+
+    int node = size();
+    types.push_back(type);
+    inputStart.push_back(0);
+    inputCounts.push_back((uint8_t)ports);
+    inputCapacity.push_back(0);
+    allocateInputs(node, ports);
+    values.push_back(0);
+    widths.push_back((uint8_t)width);
+    readerHead.push_back(-1);
+    posX.push_back(x);
+    posY.push_back(y);
+    generations.push_back(newGeneration());
+    return node;
+}
+
+void Netlist::link(int32_t slot, int32_t source)
+{
+    inputs[slot] = source;
+    prevReader[slot] = -1;
+    nextReader[slot] = readerHead[source];
+    if (readerHead[source] >= 0) prevReader[readerHead[source]] = slot;
+    readerHead[source] = slot;
+}
+
+void Netlist::unlink(int32_t slot)
+{
+    int32_t source = inputs[slot];
+    if (source < 0) return;
+    if (prevReader[slot] >= 0) nextReader[prevReader[slot]] = nextReader[slot];
+    else readerHead[source] = nextReader[slot];
+    if (nextReader[slot] >= 0) prevReader[nextReader[slot]] = prevReader[slot];
+    inputs[slot] = -1;
+    nextReader[slot] = -1;
+    prevReader[slot] = -1;
+}
+
+bool Netlist::connect(int node, int port, int source)
+{
+    if (node < 0 || node >= size() || port < 0 || port >= inputCount(node))
+        return false;
+    bool wired = source >= 0 && source < size() && isAlive(source);
+    if (wired && outputWidth(source) != inputWidth(node, port))
+        return false;
+    int32_t slot = inputStart[node] + port;
+    unlink(slot);
+    if (wired)
+        link(slot, source);
+    return true;
+}
+
+bool Netlist::setWidth(int node, int width)
+{
+    if (node < 0 || node >= size() || !isAlive(node) || width < 1 || width > MAX_WIDTH)
+        return false;
+    widths[node] = (uint8_t)width;
+    values[node] &= widthMask(outputWidth(node));
+
+    for (int p = 0; p < inputCount(node); p++)
+    {
+        int32_t source = input(node, p);
+        if (source >= 0 && outputWidth(source) != inputWidth(node, p))
+            unlink(inputStart[node] + p);
+    }
+    //the readers whose port no longer matches, the list is walked before it changes
+    int32_t slot = readerHead[node];
+    while (slot >= 0)
+    {
+        int32_t next = nextReader[slot];
+        int32_t reader = slotNode[slot];
+        if (inputWidth(reader, slot - inputStart[reader]) != outputWidth(node))
+            unlink(slot);
+        slot = next;
+    }
+    return true;
+}
+
+bool Netlist::setInputCount(int node, int count)
+{
+    if (node < 0 || node >= size() || !isAlive(node) || !gateInfo(type(node)).variadic)
+        return false;
+    count = clampInputs(type(node), count);
+    for (int p = count; p < inputCount(node); p++)
+    {
+        unlink(inputStart[node] + p);
+    }
+    if (count > inputCapacity[node])
+    {
+        //the wires move along to the new range
+        int kept = inputCount(node);
+        int32_t sources[MAX_FANIN];
+        for (int p = 0; p < kept; p++)
+        {
+            sources[p] = input(node, p);
+            unlink(inputStart[node] + p);
+        }
+        allocateInputs(node, count);
+        for (int p = 0; p < kept; p++)
+        {
+            if (sources[p] >= 0) link(inputStart[node] + p, sources[p]);
+        }
+    }
+    inputCounts[node] = (uint8_t)count;
+    return true;
+}
+
+void Netlist::remove(int node)
+{
+    if (node < 0 || node >= size() || !isAlive(node))
+        return;
+
+    //open every port that reads the node
+    while (readerHead[node] >= 0)
+    {
+        unlink(readerHead[node]);
+    }
+    //and drop its own wires from the lists of its sources
+    for (int p = 0; p < inputCount(node); p++)
+    {
+        unlink(inputStart[node] + p);
+    }
+    types[node] = GATE_NONE;
+    inputCounts[node] = 0;
+    values[node] = 0;
+    generations[node] = 0;
+    freeNodes.push_back(node);
+}
+
+void Netlist::reserve(int nodes)
+{
+    reserve(nodes, (size_t)nodes * 2);
+}
+
+void Netlist::reserve(int nodes, size_t slots)
+{
+    types.reserve(nodes);
+    inputStart.reserve(nodes);
+    inputCounts.reserve(nodes);
+    inputCapacity.reserve(nodes);
+    inputs.reserve(slots);
+    slotNode.reserve(slots);
+    values.reserve(nodes);
+    widths.reserve(nodes);
+    readerHead.reserve(nodes);
+    nextReader.reserve(slots);
+    prevReader.reserve(slots);
+    posX.reserve(nodes);
+    posY.reserve(nodes);
+    generations.reserve(nodes);
+}
+
+void Netlist::clear()
+{
+    types.clear();
+    inputStart.clear();
+    inputCounts.clear();
+    inputCapacity.clear();
+    inputs.clear();
+    slotNode.clear();
+    values.clear();
+    widths.clear();
+    readerHead.clear();
+    nextReader.clear();
+    prevReader.clear();
+    posX.clear();
+    posY.clear();
+    generations.clear();
+    freeNodes.clear();
+}
@@ -0,0 +1,323 @@
+#include <sim_worker.hpp>
+#include <chrono>
+
+//longest the worker sleeps without a command, a safety net for a missed wakeup
+static const uint64_t PARK_TIMEOUT_NS = 500000000;
+//shortest time between two snapshots while the circuit keeps changing
+static const uint64_t PUBLISH_INTERVAL_NS = 4000000;
+//most time spent ticking before the commands are checked again
+static const uint64_t TICK_BUDGET_NS = 2000000;
+//most threads a wide circuit is spread over, this one included
+static const int MAX_POOL_THREADS = 16;
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SimWorker::SimWorker() : commands(4096)
+{
+}
+
+SimWorker::~SimWorker()
+{
+    stop();
+    //loads that were never applied still own their netlist
+    Command command;
+    while (commands.pop(command))
+    {
+        if (command.kind == CMD_LOAD) delete command.netlist;
+    }
+}
+
+void SimWorker::start()
+{
+    if (running.exchange(true))
+        return;
+    thread = std::thread(&SimWorker::run, this);
+}
+
+void SimWorker::stop()
+{
+    if (!running.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+    }
+    parkSignal.notify_one();
+    thread.join();
+}
+
+void SimWorker::post(const Command& command)
+{
+    //a full queue only happens on bursts of edits, wait for the worker to drain it
+    while (!commands.push(command))
+    {
+        std::this_thread::yield();
+    }
+    //wake the worker only if it sleeps, the fence pairs with the one in park()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        parkSignal.notify_one();
+    }
+}
+
+void SimWorker::add(GateType type)
+{
+    Command c = {};
+    c.kind = CMD_ADD;
+    c.type = type;
+    post(c);
+}
+
+void SimWorker::remove(int node)
+{
+    Command c = {};
+    c.kind = CMD_REMOVE;
+    c.node = node;
+    post(c);
+}
+
+void SimWorker::connect(int node, int port, int source)
+{
+    Command c = {};
+    c.kind = CMD_CONNECT;
+    c.node = node;
+    c.port = port;
+    c.source = source;
+    post(c);
+}
+
+void SimWorker::setSwitch(int node, uint64_t value)
+{
+    Command c = {};
+    c.kind = CMD_SET_SWITCH;
+    c.node = node;
+    c.value = value;
+    post(c);
+}
+
+void SimWorker::setWidth(int node, int width)
+{
+    Command c = {};
+    c.kind = CMD_SET_WIDTH;
+    c.node = node;
+    c.port = width;
+    post(c);
+}
+
+void SimWorker::setInputCount(int node, int count)
+{
+    Command c = {};
+    c.kind = CMD_SET_INPUTS;
+    c.node = node;
+    c.port = count;
+    post(c);
+}
+
+void SimWorker::setTickRate(double ticksPerSecond)
+{
+    Command c = {};
+    c.kind = CMD_SET_RATE;
+    c.rate = ticksPerSecond;
+    post(c);
+}
+
+void SimWorker::load(const Netlist& source)
+{
+    Command c = {};
+    c.kind = CMD_LOAD;
+    c.netlist = new Netlist(source);
+    post(c);
+}
+
+void SimWorker::setBit(int node, bool value)
+{
+    uint64_t mask = (uint64_t)1 << (node & 63);
+    if (value) bits[node >> 6] |= mask;
+    else bits[node >> 6] &= ~mask;
+}
+
+void SimWorker::apply(const Command& c)
+{
+    switch (c.kind)
+    {
+        case CMD_ADD:
+            netlist.add(c.type, 0, 0);
+            bits.resize((netlist.size() + 63) / 64, 0);
+            dirty = true;
+            break;
+        case CMD_REMOVE:
+            netlist.remove(c.node);
+            if (c.node >= 0 && c.node < netlist.size()) setBit(c.node, false);
+            dirty = true;
+            break;
+        case CMD_CONNECT:
+            netlist.connect(c.node, c.port, c.source);
+            dirty = true;
+            break;
+        case CMD_SET_SWITCH:
+            if (c.node < 0 || c.node >= netlist.size())
+                break;
+            //the edits sent before it are compiled first, so a switch on the clock input of a
+            //register is an edge against the circuit as it was
+            if (dirty) recompile();
+            netlist.setValue(c.node, c.value);
+            setBit(c.node, netlist.state(c.node));
+            //only the switch's fanout gets re-evaluated
+            simulator.setSource(c.node, netlist.value(c.node));
+            break;
+        case CMD_SET_WIDTH:
+            if (c.node < 0 || c.node >= netlist.size() || !netlist.setWidth(c.node, c.port))
+                break;
+            setBit(c.node, netlist.state(c.node));
+            dirty = true;
+            break;
+        case CMD_SET_INPUTS:
+            netlist.setInputCount(c.node, c.port);
+            dirty = true;
+            break;
+        case CMD_SET_RATE:
+            clock.setRate(c.rate);
+            break;
+        case CMD_LOAD:
+            netlist = std::move(*c.netlist);
+            delete c.netlist;
+            bits.assign((netlist.size() + 63) / 64, 0);
+            for (int i = 0; i < netlist.size(); i++)
+            {
+                if (netlist.state(i)) setBit(i, true);
+            }
+            dirty = true;
+            break;
+    }
+    unpublished = true;
+}
+
+void SimWorker::recompile()
+{
+    simulator.compile(netlist);
+    //the pool only starts once a circuit has a level wide enough to split, small ones never
+    //pay for its threads, and it stays for the circuits loaded after
+    if (simulator.threadCount() == 1 && simulator.getProgram().widestLevel() >= PARALLEL_MIN_WIDTH)
+    {
+        int cores = (int)std::thread::hardware_concurrency(); //0 when it can't tell
+        simulator.setThreadCount(cores < 1 ? 1 : cores > MAX_POOL_THREADS ? MAX_POOL_THREADS : cores);
+    }
+    storeChanged();
+    busNodes.clear();
+    for (int i = 0; i < netlist.size(); i++)
+    {
+        if (netlist.isAlive(i) && netlist.outputWidth(i) > 1) busNodes.push_back(i);
+    }
+    dirty = false;
+}
+
+void SimWorker::storeChanged()
+{
+    for (int32_t net : simulator.getChanged())
+    {
+        uint64_t value = simulator.word(net);
+        netlist.setValue(net, value); //kept so a recompile starts from the current state
+        setBit(net, value != 0);
+        unpublished = true;
+    }
+}
+
+void SimWorker::publish()
+{
+    SimSnapshot& snap = snapshots.back();
+    snap.bits = bits; //same size as last time in steady state, no allocation
+    snap.nodeCount = netlist.size();
+    snap.busNodes = busNodes;
+    snap.busValues.resize(busNodes.size());
+    for (size_t i = 0; i < busNodes.size(); i++)
+    {
+        snap.busValues[i] = netlist.value(busNodes[i]);
+    }
+    snap.oscillatingLoops = simulator.oscillatingCount();
+    snap.unstable.assign(bits.size(), 0);
+    if (snap.oscillatingLoops > 0)
+    {
+        const Program& program = simulator.getProgram();
+        for (int loop = 0; loop < program.loopCount(); loop++)
+        {
+            if (!simulator.isOscillating(loop)) continue;
+            for (int32_t slot = program.loopBegin[loop]; slot < program.loopEnd[loop]; slot++)
+            {
+                int32_t node = program.target[slot];
+                snap.unstable[node >> 6] |= (uint64_t)1 << (node & 63);
+            }
+        }
+    }
+    snap.tick = ticks;
+    snap.settled = !simulator.isRunning();
+    snapshots.publish();
+    unpublished = false;
+    if (onPublish) onPublish();
+}
+
+void SimWorker::park(uint64_t timeoutNs)
+{
+    std::unique_lock<std::mutex> lock(parkMutex);
+    parked.store(true, std::memory_order_relaxed);
+    //a command pushed before this fence is seen by empty(), one pushed after it sees parked
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    parkSignal.wait_for(lock, std::chrono::nanoseconds(timeoutNs), [this] {
+        return !commands.empty() || !running.load();
+    });
+    parked.store(false, std::memory_order_relaxed);
+}
+
+void SimWorker::run()
+{
+    uint64_t lastPublish = 0;
+    while (running.load())
+    {
+        Command command;
+        while (commands.pop(command))
+        {
+            apply(command);
+        }
+        if (dirty)
+            recompile();
+
+        //the ticks that are due, one step() each: the logic settles and the registers latch,
+        //with clock sources in the circuit every tick is one clock cycle
+        uint64_t now = nowNs();
+        int64_t due = clock.advance(now);
+        for (int64_t tick = 0; tick < due && simulator.isRunning(); tick++)
+        {
+            int oscillating = simulator.oscillatingCount();
+            simulator.step();
+            ticks++;
+            if (simulator.oscillatingCount() != oscillating) unpublished = true;
+            storeChanged();
+            if ((tick & 63) == 63 && (nowNs() - now > TICK_BUDGET_NS || !commands.empty()))
+                break;
+        }
+
+        bool pending = simulator.isRunning();
+        now = nowNs();
+        if (unpublished && (!pending || now - lastPublish >= PUBLISH_INTERVAL_NS))
+        {
+            publish();
+            lastPublish = now;
+        }
+
+        if (!pending)
+        {
+            clock.idle();
+            if (commands.empty()) park(PARK_TIMEOUT_NS);
+        }
+        else if (!clock.unlimited())
+        {
+            //rate limited, sleep until the next tick unless a command arrives
+            uint64_t wait = clock.nsUntilNextTick();
+            if (wait > 0 && commands.empty()) park(wait);
+        }
+    }
+}
@@ -0,0 +1,673 @@
+#include <simulator.hpp>
+
+void Simulator::compile(const Netlist& netlist)
+{
+    const int32_t n = netlist.size();
+    const int32_t ground = n; //open inputs read this net, it is always low
+
+    //1. decode every node into an instruction, the input nets of node i are in[inStart[i], inStart[i + 1])
+    std::vector<uint8_t> op(n, OP_SOURCE);
+    std::vector<uint8_t> folded(n, OP_SOURCE); //two-input opcode of the OP_REDUCE gates
+    std::vector<int32_t> inStart(n + 1, 0);
+    std::vector<int32_t> in;
+    std::vector<int32_t> probes;
+    in.reserve((size_t)n * 2);
+    program.clocks.clear();
+    program.registers.clear();
+    program.registerOp.clear();
+    program.registerData.clear();
+    program.registerClock.clear();
+    program.registerEnable.clear();
+
+    for (int32_t i = 0; i < n; i++)
+    {
+        //sequential elements only read their inputs at a clock edge, they are sources here
+        if (gateInfo(netlist.type(i)).sequential)
+        {
+            auto netOf = [&](int port) -> int32_t {
+                int32_t source = netlist.input(i, port);
+                return source >= 0 ? source : ground;
+            };
+            const GateType type = netlist.type(i);
+            program.registers.push_back(i);
+            program.registerOp.push_back(type == GATE_DFF ? OP_DFF : type == GATE_REG ? OP_REG : OP_COUNTER);
+            program.registerData.push_back(netOf(0));
+            program.registerClock.push_back(netOf(1));
+            program.registerEnable.push_back(type != GATE_DFF ? netlist.input(i, 2) : -1);
+            inStart[i + 1] = (int32_t)in.size();
+            continue;
+        }
+        if (netlist.type(i) == GATE_CLOCK) program.clocks.push_back(i);
+
+        //switches, clocks and removed nodes have no inputs
+        for (int port = 0; port < netlist.inputCount(i); port++)
+        {
+            int32_t source = netlist.input(i, port);
+            in.push_back(source >= 0 ? source : ground);
+        }
+        inStart[i + 1] = (int32_t)in.size();
+
+        switch (netlist.type(i))
+        {
+            case GATE_AND:  op[i] = OP_AND;  break;
+            case GATE_OR:   op[i] = OP_OR;   break;
+            case GATE_XOR:  op[i] = OP_XOR;  break;
+            case GATE_NAND: op[i] = OP_NAND; break;
+            case GATE_NOR:  op[i] = OP_NOR;  break;
+            case GATE_XNOR: op[i] = OP_XNOR; break;
+            case GATE_ADD:  op[i] = OP_ADD;  break;
+            case GATE_MUX:  op[i] = OP_MUX;  break;
+            case GATE_EQ:   op[i] = OP_EQ;   break;
+            case GATE_LT:   op[i] = OP_LT;   break;
+            case GATE_NOT:
+                //an unconnected not gate stays low, so it buffers ground instead
+                op[i] = in[inStart[i]] != ground ? OP_NOT : OP_BUF;
+                break;
+            case GATE_LIGHT:
+                op[i] = OP_BUF;
+                probes.push_back(i);
+                break;
+            default:
+                //switches, clocks, and removed nodes which nothing reads
+                op[i] = OP_SOURCE;
+                break;
+        }
+        //two inputs keep the plain instruction, more fold it over their list
+        if (inStart[i + 1] - inStart[i] > 2 && gateInfo(netlist.type(i)).variadic)
+        {
+            folded[i] = op[i];
+            op[i] = OP_REDUCE;
+        }
+    }
+
+    //2. fanout lists (CSR)
+    fanoutStart.assign(n + 1, 0);
+    for (int32_t k = 0; k < (int32_t)in.size(); k++)
+    {
+        if (in[k] != ground) fanoutStart[in[k] + 1]++;
+    }
+    for (int32_t i = 0; i < n; i++)
+    {
+        fanoutStart[i + 1] += fanoutStart[i];
+    }
+    fanout.assign(fanoutStart[n], 0);
+    std::vector<int32_t> fill(fanoutStart.begin(), fanoutStart.end() - 1);
+    for (int32_t i = 0; i < n; i++)
+    {
+        for (int32_t k = inStart[i]; k < inStart[i + 1]; k++)
+        {
+            if (in[k] != ground) fanout[fill[in[k]]++] = i;
+        }
+    }
+
+    //3. strongly connected components, tarjan's algorithm with an explicit stack
+    //a component of several gates, or a gate reading itself, is a combinational loop
+    //members are kept in discovery order, which follows the wires, so one sweep carries a change far
+    std::vector<int32_t> index(n, -1);
+    std::vector<int32_t> low(n, 0);
+    std::vector<int32_t> edge(n, 0);
+    std::vector<uint8_t> onStack(n, 0);
+    std::vector<int32_t> stack;
+    std::vector<int32_t> path;
+    std::vector<int32_t> members;     //nodes grouped by component, sinks first
+    std::vector<int32_t> memberStart; //component c is members[memberStart[c], memberStart[c + 1])
+    members.reserve(n);
+    int32_t counter = 0;
+    auto visit = [&](int32_t u) {
+        index[u] = low[u] = counter++;
+        edge[u] = fanoutStart[u];
+        onStack[u] = 1;
+        stack.push_back(u);
+        path.push_back(u);
+    };
+    for (int32_t root = 0; root < n; root++)
+    {
+        if (index[root] >= 0) continue;
+        visit(root);
+        while (!path.empty())
+        {
+            int32_t u = path.back();
+            if (edge[u] < fanoutStart[u + 1])
+            {
+                int32_t r = fanout[edge[u]++];
+                if (index[r] < 0) visit(r);
+                else if (onStack[r] && index[r] < low[u]) low[u] = index[r];
+                continue;
+            }
+            path.pop_back();
+            if (!path.empty() && low[u] < low[path.back()]) low[path.back()] = low[u];
+            if (low[u] != index[u]) continue;
+
+            //u is the root of a component, its members are on the stack above it
+            size_t first = stack.size();
+            do { first--; onStack[stack[first]] = 0; } while (stack[first] != u);
+            memberStart.push_back((int32_t)members.size());
+            members.insert(members.end(), stack.begin() + first, stack.end());
+            stack.resize(first);
+        }
+    }
+    const int32_t components = (int32_t)memberStart.size();
+    memberStart.push_back(n);
+
+    //4. levels, components come out sinks first so they are walked backwards
+    //a component's level is one more than its deepest input from outside of it
+    std::vector<int32_t> level(n, 0);
+    std::vector<int32_t> componentOf(n, 0);
+    std::vector<int32_t> loopComponents; //cyclic components, inputs first
+    int32_t maxLevel = 0;
+    for (int32_t c = components - 1; c >= 0; c--)
+    {
+        int32_t depth = 0;
+        bool cyclic = memberStart[c + 1] - memberStart[c] > 1;
+        for (int32_t k = memberStart[c]; k < memberStart[c + 1]; k++)
+        {
+            componentOf[members[k]] = c;
+        }
+        for (int32_t k = memberStart[c]; k < memberStart[c + 1]; k++)
+        {
+            int32_t u = members[k];
+            for (int32_t e = inStart[u]; e < inStart[u + 1]; e++)
+            {
+                int32_t source = in[e];
+                if (source == ground) continue;
+                if (source == u) cyclic = true;
+                else if (componentOf[source] != c && level[source] + 1 > depth) depth = level[source] + 1;
+            }
+        }
+        for (int32_t k = memberStart[c]; k < memberStart[c + 1]; k++)
+        {
+            level[members[k]] = depth;
+        }
+        if (cyclic) loopComponents.push_back(c);
+        if (depth > maxLevel) maxLevel = depth;
+    }
+    const int32_t numLevels = n > 0 ? maxLevel + 1 : 0;
+
+    //5. counting sort by level into the flat program, switches are not instructions
+    //each level holds its acyclic gates first, then its loops one after the other
+    std::vector<uint8_t> inLoop(n, 0);
+    for (int32_t c : loopComponents)
+    {
+        for (int32_t k = memberStart[c]; k < memberStart[c + 1]; k++) inLoop[members[k]] = 1;
+    }
+    std::vector<int32_t> levelStart(numLevels + 1, 0);
+    std::vector<int32_t> loopSlots(numLevels, 0); //slots taken by loops, per level
+    std::vector<int32_t> levelLoops(numLevels + 1, 0);
+    for (int32_t i = 0; i < n; i++)
+    {
+        if (op[i] == OP_SOURCE) continue;
+        levelStart[level[i] + 1]++;
+        if (inLoop[i]) loopSlots[level[i]]++;
+    }
+    for (int32_t c : loopComponents)
+    {
+        levelLoops[level[members[memberStart[c]]] + 1]++;
+    }
+    for (int32_t l = 0; l < numLevels; l++)
+    {
+        levelStart[l + 1] += levelStart[l];
+        levelLoops[l + 1] += levelLoops[l];
+    }
+
+    const int32_t count = numLevels > 0 ? levelStart[numLevels] : 0;
+    const int32_t loops = (int32_t)loopComponents.size();
+    program.levelStart = levelStart;
+    program.opcodes.assign(count, OP_BUF);
+    program.operandA.assign(count, ground);
+    program.operandB.assign(count, ground);
+    program.operandC.assign(count, ground);
+    program.target.assign(count, ground);
+    program.slotLevel.assign(count, 0);
+    program.slotLoop.assign(count, -1);
+    program.loopBegin.assign(loops, 0);
+    program.loopEnd.assign(loops, 0);
+    program.sources.clear();
+    program.probes = probes;
+    program.netCount = n;
+    program.numLevels = numLevels;
+    program.netMask.assign(n + 1, 1);
+    program.wide = false;
+    for (int32_t i = 0; i < n; i++)
+    {
+        program.netMask[i] = widthMask(netlist.outputWidth(i));
+        if (netlist.isAlive(i) && netlist.outputWidth(i) > 1) program.wide = true;
+    }
+    std::vector<int32_t> slotOf(n, -1);
+
+    auto place = [&](int32_t i, int32_t slot) {
+        program.opcodes[slot] = op[i];
+        program.target[slot] = i;
+        program.slotLevel[slot] = level[i];
+        slotOf[i] = slot;
+    };
+
+    //the loop area of a level starts after its acyclic gates
+    std::vector<int32_t> loopCursor(numLevels, 0);
+    for (int32_t l = 0; l < numLevels; l++)
+    {
+        loopCursor[l] = levelStart[l + 1] - loopSlots[l];
+    }
+    for (int32_t c : loopComponents)
+    {
+        int32_t l = level[members[memberStart[c]]];
+        int32_t loop = levelLoops[l]++;
+        program.loopBegin[loop] = loopCursor[l];
+        for (int32_t k = memberStart[c]; k < memberStart[c + 1]; k++)
+        {
+            program.slotLoop[loopCursor[l]] = loop;
+            place(members[k], loopCursor[l]++);
+        }
+        program.loopEnd[loop] = loopCursor[l];
+    }
+
+    for (int32_t i = 0; i < n; i++)
+    {
+        if (op[i] == OP_SOURCE)
+        {
+            if (netlist.type(i) == GATE_SWITCH) program.sources.push_back(i);
+            continue;
+        }
+        if (!inLoop[i]) place(i, levelStart[level[i]]++);
+    }
+
+    //the operands, in slot order so the fanin lists are read front to back
+    program.fanin.clear();
+    for (int32_t slot = 0; slot < count; slot++)
+    {
+        const int32_t i = program.target[slot];
+        const int32_t first = inStart[i];
+        const int32_t inputs = inStart[i + 1] - first;
+        if (op[i] == OP_REDUCE)
+        {
+            program.operandA[slot] = (int32_t)program.fanin.size();
+            program.operandB[slot] = inputs;
+            program.operandC[slot] = folded[i];
+            program.fanin.insert(program.fanin.end(), in.begin() + first, in.begin() + first + inputs);
+            continue;
+        }
+        program.operandA[slot] = inputs > 0 ? in[first] : ground;
+        program.operandB[slot] = inputs > 1 ? in[first + 1] : ground;
+        program.operandC[slot] = inputs > 2 ? in[first + 2] : ground;
+    }
+
+    //readers are stored as program slots so the event loop can index them directly
+    for (int32_t& reader : fanout)
+    {
+        reader = slotOf[reader];
+    }
+
+    //6. start from the current state so an edit doesn't reset the circuit
+    nets.assign(n + 1, 0);
+    for (int32_t i = 0; i < n; i++)
+    {
+        nets[i] = netlist.value(i) & program.netMask[i];
+    }
+    changed.clear();
+    lastClock.assign(program.registers.size(), 0);
+    //the nets the registers sample, a change on one of them needs a latch even if no gate reads it
+    feedsRegister.assign(n + 1, 0);
+    for (size_t k = 0; k < program.registers.size(); k++)
+    {
+        feedsRegister[program.registerData[k]] = 1;
+        feedsRegister[program.registerClock[k]] = 1;
+        if (program.registerEnable[k] >= 0) feedsRegister[program.registerEnable[k]] = 1;
+    }
+    latchPending = false;
+    oscillating.assign(loops, 0);
+    oscillatingLoops = 0;
+
+    //7. everything is pending once, the first settle() is a full pass
+    pending.assign(numLevels, std::vector<int32_t>());
+    queued.assign(count, 0);
+    lowestPending = numLevels;
+    for (int32_t slot = 0; slot < count; slot++)
+    {
+        schedule(slot);
+    }
+
+    //8. a recompile is not a clock edge: with registers, the logic settles here and they take
+    //the clocks as they are now, so only a source that changes after compile() makes an edge
+    if (!program.registers.empty())
+    {
+        propagate();
+        for (size_t k = 0; k < program.registers.size(); k++)
+        {
+            lastClock[k] = nets[program.registerClock[k]] & 1;
+        }
+    }
+}
+
+// @brief
+// new value of the net a slot drives, from the current nets
+inline uint64_t Simulator::compute(int32_t slot) const
+{
+    const Program& p = program;
+    const uint64_t* v = nets.data();
+    const uint64_t mask = p.netMask[p.target[slot]];
+    if (p.opcodes[slot] == OP_REDUCE)
+        return reduceOp<uint64_t>((uint8_t)p.operandC[slot], v, &p.fanin[p.operandA[slot]], p.operandB[slot], mask);
+    return applyWordOp(p.opcodes[slot], v[p.operandA[slot]], v[p.operandB[slot]], v[p.operandC[slot]], mask);
+}
+
+void Simulator::schedule(int32_t slot)
+{
+    if (queued[slot]) return;
+    queued[slot] = 1;
+    int32_t l = program.slotLevel[slot];
+    pending[l].push_back(slot);
+    if (l < lowestPending) lowestPending = l;
+}
+
+void Simulator::scheduleReaders(int32_t net)
+{
+    for (int32_t k = fanoutStart[net]; k < fanoutStart[net + 1]; k++)
+    {
+        schedule(fanout[k]);
+    }
+}
+
+void Simulator::setSource(int net, uint64_t value)
+{
+    if (net < 0 || net >= program.netCount) return;
+    uint64_t v = value & program.netMask[net];
+    if (nets[net] == v) return;
+    nets[net] = v;
+    if (feedsRegister[net]) latchPending = true;
+    scheduleReaders(net);
+}
+
+// @brief
+// flags a latch if a net that changed since changed was cleared is sampled by a register
+void Simulator::noteRegisterInputs()
+{
+    if (program.registers.empty() || latchPending) return;
+    for (int32_t net : changed)
+    {
+        if (feedsRegister[net])
+        {
+            latchPending = true;
+            return;
+        }
+    }
+}
+
+bool Simulator::settle()
+{
+    changed.clear();
+    propagate();
+    noteRegisterInputs();
+    return !changed.empty();
+}
+
+bool Simulator::step()
+{
+    changed.clear();
+    if (program.clocks.empty())
+    {
+        propagate();
+        for (int round = 0; round < LATCH_ROUND_LIMIT && latch(); round++) propagate();
+    }
+    else
+    {
+        for (uint64_t level : {1ull, 0ull})
+        {
+            for (int32_t clock : program.clocks)
+            {
+                if (nets[clock] == level) continue;
+                nets[clock] = level;
+                changed.push_back(clock);
+                scheduleReaders(clock);
+            }
+            propagate();
+            for (int round = 0; round < LATCH_ROUND_LIMIT && latch(); round++) propagate();
+        }
+    }
+    latchPending = false;
+    return !changed.empty();
+}
+
+// @brief
+// every register whose clock input rose since the last call computes its next value from the
+// nets as they are, then all of them load, so a register never sees another one's new value
+// returns true if an output changed, its readers are scheduled
+bool Simulator::latch()
+{
+    const Program& p = program;
+    uint64_t* v = nets.data();
+    latched.clear();
+    for (size_t k = 0; k < p.registers.size(); k++)
+    {
+        uint8_t clock = v[p.registerClock[k]] & 1;
+        bool rose = clock && !lastClock[k];
+        lastClock[k] = clock;
+        if (!rose) continue;
+
+        const int32_t net = p.registers[k];
+        const bool enabled = p.registerEnable[k] < 0 || v[p.registerEnable[k]] != 0;
+        uint64_t next = v[net];
+        switch (p.registerOp[k])
+        {
+            case OP_DFF: next = v[p.registerData[k]]; break;
+            case OP_REG: if (enabled) next = v[p.registerData[k]]; break;
+            default: //counter, the reset is synchronous and wins over the enable
+                if (v[p.registerData[k]] != 0) next = 0;
+                else if (enabled) next = (v[net] + 1) & p.netMask[net];
+                break;
+        }
+        if (next != v[net]) latched.push_back({net, next});
+    }
+    for (const auto& load : latched)
+    {
+        v[load.first] = load.second;
+        changed.push_back(load.first);
+        scheduleReaders(load.first);
+    }
+    return !latched.empty();
+}
+
+// @brief
+// the body of settle(), the nets that change are added to the ones already in changed
+void Simulator::propagate()
+{
+    uint64_t* v = nets.data();
+    const Program& p = program;
+
+    while (lowestPending < p.numLevels)
+    {
+        int32_t l = lowestPending;
+        //take the bucket, readers always land on a higher level, loops included
+        processing.swap(pending[l]);
+        pending[l].clear();
+        lowestPending = l + 1;
+
+        if (runParallel((int32_t)processing.size()))
+        {
+            //the gates are computed in parallel, scheduling their readers stays serial
+            pool->parallelFor((int32_t)processing.size(), chunkSize((int32_t)processing.size()),
+                              [&](int32_t begin, int32_t end, int worker) {
+                std::vector<int32_t>& out = workerChanged[worker];
+                for (int32_t k = begin; k < end; k++)
+                {
+                    int32_t slot = processing[k];
+                    if (p.slotLoop[slot] >= 0) continue; //loops are swept below
+                    queued[slot] = 0;
+                    int32_t net = p.target[slot];
+                    uint64_t value = compute(slot);
+                    if (v[net] != value)
+                    {
+                        v[net] = value;
+                        out.push_back(net);
+                    }
+                }
+            });
+            for (std::vector<int32_t>& out : workerChanged)
+            {
+                for (int32_t net : out)
+                {
+                    changed.push_back(net);
+                    scheduleReaders(net);
+                }
+                out.clear();
+            }
+            for (int32_t slot : processing)
+            {
+                if (queued[slot]) solveLoop(p.slotLoop[slot], changed);
+            }
+        }
+        else
+        {
+            for (int32_t slot : processing)
+            {
+                //the other members of a loop that was already swept
+                if (!queued[slot]) continue;
+                if (p.slotLoop[slot] >= 0)
+                {
+                    solveLoop(p.slotLoop[slot], changed);
+                    continue;
+                }
+                queued[slot] = 0;
+                int32_t net = p.target[slot];
+                uint64_t out = compute(slot);
+
+                if (v[net] != out)
+                {
+                    v[net] = out;
+                    changed.push_back(net);
+                    scheduleReaders(net);
+                }
+            }
+        }
+        processing.clear();
+    }
+}
+
+void Simulator::evaluate()
+{
+    const Program& p = program;
+    changed.clear();
+
+    //level by level, a level only reads the ones before it so its acyclic chunks are independent
+    //its loops only read themselves besides that, they are swept once the rest of the level is done
+    int32_t loop = 0;
+    for (int32_t l = 0; l < p.numLevels; l++)
+    {
+        const int32_t begin = p.levelStart[l];
+        const int32_t end = p.levelStart[l + 1];
+        const int32_t acyclicEnd = loop < p.loopCount() && p.loopBegin[loop] < end ? p.loopBegin[loop] : end;
+        const int32_t width = acyclicEnd - begin;
+        if (runParallel(width))
+        {
+            pool->parallelFor(width, chunkSize(width), [&](int32_t from, int32_t to, int worker) {
+                evaluateSlots(begin + from, begin + to, workerChanged[worker]);
+            });
+        }
+        else
+        {
+            evaluateSlots(begin, acyclicEnd, changed);
+        }
+        for (; loop < p.loopCount() && p.loopBegin[loop] < end; loop++)
+        {
+            solveLoop(loop, changed);
+        }
+    }
+    for (std::vector<int32_t>& out : workerChanged)
+    {
+        changed.insert(changed.end(), out.begin(), out.end());
+        out.clear();
+    }
+
+    //a full pass leaves nothing to do for the event loop
+    for (int32_t l = 0; l < p.numLevels; l++)
+    {
+        for (int32_t slot : pending[l]) queued[slot] = 0;
+        pending[l].clear();
+    }
+    lowestPending = p.numLevels;
+    noteRegisterInputs();
+}
+
+void Simulator::evaluateSlots(int32_t begin, int32_t end, std::vector<int32_t>& out)
+{
+    const Program& p = program;
+    uint64_t* v = nets.data();
+    for (int32_t k = begin; k < end; k++)
+    {
+        int32_t net = p.target[k];
+        uint64_t value = compute(k);
+        if (v[net] != value)
+        {
+            v[net] = value;
+            out.push_back(net);
+        }
+    }
+}
+
+// @brief
+// sweeps the gates of a loop in slot order until a sweep changes nothing
+// the readers outside the loop are scheduled for the nets that ended up different
+void Simulator::solveLoop(int32_t loop, std::vector<int32_t>& out)
+{
+    const Program& p = program;
+    uint64_t* v = nets.data();
+    const int32_t begin = p.loopBegin[loop];
+    const int32_t end = p.loopEnd[loop];
+
+    loopEntry.clear();
+    for (int32_t slot = begin; slot < end; slot++)
+    {
+        queued[slot] = 0;
+        loopEntry.push_back(v[p.target[slot]]);
+    }
+
+    bool stable = false;
+    for (int sweep = 0; sweep < LOOP_SWEEP_LIMIT && !stable; sweep++)
+    {
+        stable = true;
+        for (int32_t slot = begin; slot < end; slot++)
+        {
+            int32_t net = p.target[slot];
+            uint64_t value = compute(slot);
+            if (v[net] != value)
+            {
+                v[net] = value;
+                stable = false;
+            }
+        }
+    }
+    if (oscillating[loop] != !stable)
+    {
+        oscillating[loop] = !stable;
+        oscillatingLoops += stable ? -1 : 1;
+    }
+
+    for (int32_t slot = begin; slot < end; slot++)
+    {
+        int32_t net = p.target[slot];
+        if (v[net] == loopEntry[slot - begin]) continue;
+        out.push_back(net);
+        for (int32_t k = fanoutStart[net]; k < fanoutStart[net + 1]; k++)
+        {
+            if (p.slotLoop[fanout[k]] != loop) schedule(fanout[k]);
+        }
+    }
+}
+
+void Simulator::setThreadCount(int threads)
+{
+    if (threads == threadCount())
+        return;
+    pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+    workerChanged.assign(threads > 1 ? threads : 0, std::vector<int32_t>());
+}
+
+bool Simulator::runParallel(int32_t width) const
+{
+    return pool && width >= PARALLEL_MIN_WIDTH;
+}
+
+int32_t Simulator::chunkSize(int32_t width) const
+{
+    //a few chunks per thread so the fast ones can take over from the slow ones
+    int32_t chunk = width / (pool->size() * 8);
+    return chunk > 1024 ? chunk : 1024;
+}
@@ -0,0 +1,81 @@
+#include <thread_pool.hpp>
+
+//rounds a worker spins for the next job before it sleeps, consecutive levels come quickly
+static const int SPIN_ROUNDS = 2000;
+
+ThreadPool::ThreadPool(int threads)
+{
+    for (int i = 1; i < threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::runChunks(int participant)
+{
+    while (true)
+    {
+        int32_t begin = nextChunk.fetch_add(jobChunk, std::memory_order_relaxed);
+        if (begin >= jobCount)
+            return;
+        int32_t end = begin + jobChunk < jobCount ? begin + jobChunk : jobCount;
+        jobInvoke(jobContext, begin, end, participant);
+    }
+}
+
+void ThreadPool::dispatch(int32_t count, int32_t chunk, Invoke invoke, void* context)
+{
+    jobInvoke = invoke;
+    jobContext = context;
+    jobCount = count;
+    jobChunk = chunk > 0 ? chunk : 1;
+    nextChunk.store(0, std::memory_order_relaxed);
+    busyWorkers.store((int)workers.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    runChunks(0);
+    //every worker takes part in every job, so the next one can't start under a late worker
+    while (busyWorkers.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void ThreadPool::workerLoop(int participant)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        for (int spin = 0; spin < SPIN_ROUNDS && generation.load(std::memory_order_acquire) == seen; spin++)
+        {
+            std::this_thread::yield();
+        }
+        if (generation.load(std::memory_order_acquire) == seen)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation.load(std::memory_order_acquire) != seen; });
+            if (stopping)
+                return;
+        }
+        seen = generation.load(std::memory_order_acquire);
+        runChunks(participant);
+        busyWorkers.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
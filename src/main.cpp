@@ -1,8 +1,17 @@
 #include <Application.hpp>
+#include <cstdlib>
+#include <string>
 int main(int argc, char* argv[]) {
     //create app on stack
     Application app;
 
+    //--fps N caps the frame rate while the circuit is changing
+    //--tps N runs the simulation at N ticks per second (0 = as fast as possible)
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--fps") app.setFrameCap(std::atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--tps") app.setTickRate(std::atof(argv[i + 1]));
+    }
+
     //run it
     app.run();
 
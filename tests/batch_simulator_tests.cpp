@@ -0,0 +1,124 @@
+// the bit-parallel engine against the scalar one, lane by lane
+#include "check.hpp"
+#include <batch_simulator.hpp>
+#include <lanes.hpp>
+#include <netlist.hpp>
+#include <simulator.hpp>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// @brief
+// random single bit logic on some switches, every gate reads nodes added before it,
+// plus NOR latches set and reset from that logic so the program has loops
+static Netlist randomCircuit(int switches, int gates, int latches, unsigned seed)
+{
+    const GateType kinds[] = {GATE_AND, GATE_OR, GATE_NOT, GATE_XOR, GATE_MUX, GATE_EQ, GATE_LT,
+                              GATE_NAND, GATE_NOR, GATE_XNOR};
+    std::mt19937 rng(seed);
+    Netlist netlist;
+    for (int i = 0; i < switches; i++) netlist.add(GATE_SWITCH, 0, 0);
+    for (int i = 0; i < gates; i++)
+    {
+        GateType type = kinds[rng() % 10];
+        int ports = gateInfo(type).variadic && rng() % 3 == 0 ? 2 + (int)(rng() % 6) : 0;
+        int gate = netlist.add(type, 0, 0, 1, ports);
+        for (int p = 0; p < netlist.inputCount(gate); p++) netlist.connect(gate, p, (int)(rng() % gate));
+    }
+    const int logic = netlist.size();
+    for (int i = 0; i < latches; i++)
+    {
+        int q = netlist.add(GATE_NOR, 0, 0);
+        int nq = netlist.add(GATE_NOR, 0, 0);
+        netlist.connect(q, 0, (int)(rng() % logic));
+        netlist.connect(q, 1, nq);
+        netlist.connect(nq, 0, q);
+        netlist.connect(nq, 1, (int)(rng() % logic));
+    }
+    //lights on the latches and on a sample of the gates
+    const int end = netlist.size();
+    for (int node = switches; node < end; node++)
+    {
+        if (node >= logic || rng() % 4 == 0) netlist.connect(netlist.add(GATE_LIGHT, 0, 0), 0, node);
+    }
+    return netlist;
+}
+
+// @brief
+// every lane of exhaustive() has to be what the scalar engine computes for its pattern
+// each pattern gets a fresh simulator, the batch starts every lane from all nets low too
+template<typename Word>
+static void exhaustiveMatchesScalar(const Netlist& netlist)
+{
+    std::vector<int> lights;
+    for (int node = 0; node < netlist.size(); node++)
+    {
+        if (netlist.type(node) == GATE_LIGHT) lights.push_back(node);
+    }
+
+    Simulator simulator;
+    simulator.compile(netlist);
+    CHECK(simulator.loopCount() > 0);
+    BatchSimulator<Word> batch(simulator.getProgram());
+    //the batch keeps its own program, recompiling the simulator it came from changes nothing
+    simulator.compile(Netlist());
+    CHECK(batch.outputCount() == (int)lights.size());
+
+    const int inputs = batch.inputCount();
+    uint64_t covered = 0;
+    int mismatches = 0;
+    bool ran = batch.exhaustive([&](uint64_t first, int lanes) {
+        for (int j = 0; j < lanes; j++)
+        {
+            const uint64_t pattern = first + j;
+            Simulator scalar;
+            scalar.compile(netlist);
+            for (int k = 0; k < inputs; k++) scalar.setSource(k, (pattern >> k) & 1);
+            scalar.evaluate();
+            for (int k = 0; k < batch.outputCount(); k++)
+            {
+                if (Lanes<Word>::get(batch.output(k), j) != scalar.value(lights[k])) mismatches++;
+            }
+            covered++;
+        }
+    });
+    CHECK(ran);
+    CHECK(covered == (1ull << inputs));
+    CHECK(mismatches == 0);
+}
+
+// @brief
+// past EXHAUSTIVE_MAX_INPUTS nothing runs and exhaustive() says so
+static void tooManyInputs()
+{
+    Netlist netlist;
+    for (int i = 0; i <= EXHAUSTIVE_MAX_INPUTS; i++) netlist.add(GATE_SWITCH, 0, 0);
+    int gate = netlist.add(GATE_AND, 0, 0);
+    netlist.connect(gate, 0, 0);
+    netlist.connect(gate, 1, EXHAUSTIVE_MAX_INPUTS);
+    netlist.connect(netlist.add(GATE_LIGHT, 0, 0), 0, gate);
+
+    Simulator simulator;
+    simulator.compile(netlist);
+    BatchSimulator<Lanes64> batch(simulator.getProgram());
+    CHECK(batch.inputCount() == EXHAUSTIVE_MAX_INPUTS + 1);
+    int blocks = 0;
+    CHECK(!batch.exhaustive([&](uint64_t, int) { blocks++; }));
+    CHECK(blocks == 0);
+}
+
+int main()
+{
+    //10 inputs: 16 blocks of 64 lanes, 4 blocks of 256, 2 of 512
+    Netlist netlist = randomCircuit(10, 200, 3, 3);
+    exhaustiveMatchesScalar<Lanes64>(netlist);
+    exhaustiveMatchesScalar<Lanes256>(netlist);
+    exhaustiveMatchesScalar<Lanes512>(netlist);
+    //fewer inputs than a word has lane bits, one partial block
+    Netlist small = randomCircuit(5, 40, 1, 5);
+    exhaustiveMatchesScalar<Lanes64>(small);
+    exhaustiveMatchesScalar<Lanes256>(small);
+    tooManyInputs();
+    if (failures == 0) std::printf("all batch simulator tests passed\n");
+    return failures;
+}
@@ -0,0 +1,13 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+#include <cstdio>
+
+// @brief
+// the tests use no framework: every failed check prints where it is and counts,
+// main() returns the count so ctest sees a failure
+inline int failures = 0;
+
+#define CHECK(cond) \
+    do { if (!(cond)) { std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+#endif // CHECK_HPP
@@ -0,0 +1,362 @@
+// circuit files: round trips between the formats and files that have to be rejected
+// the fixtures in tests/circuits are read from the directory given as the first argument
+#include "check.hpp"
+#include <circuit_io.hpp>
+#include <netlist.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::string circuits = ".";
+
+static std::vector<uint8_t> readFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+}
+
+// @brief
+// same circuit up to the removed nodes: the files number the live nodes densely in order
+static bool sameCircuit(const Netlist& a, const Netlist& b)
+{
+    std::vector<int> aNodes, bNodes, aIndex(a.size(), -1), bIndex(b.size(), -1);
+    for (int i = 0; i < a.size(); i++)
+        if (a.isAlive(i)) { aIndex[i] = (int)aNodes.size(); aNodes.push_back(i); }
+    for (int i = 0; i < b.size(); i++)
+        if (b.isAlive(i)) { bIndex[i] = (int)bNodes.size(); bNodes.push_back(i); }
+    if (aNodes.size() != bNodes.size()) return false;
+
+    for (size_t k = 0; k < aNodes.size(); k++)
+    {
+        int i = aNodes[k], j = bNodes[k];
+        if (a.type(i) != b.type(j) || a.width(i) != b.width(j) || a.inputCount(i) != b.inputCount(j)
+            || a.x(i) != b.x(j) || a.y(i) != b.y(j))
+            return false;
+        for (int p = 0; p < a.inputCount(i); p++)
+        {
+            int sa = a.input(i, p), sb = b.input(j, p);
+            if ((sa < 0 ? -1 : aIndex[sa]) != (sb < 0 ? -1 : bIndex[sb])) return false;
+        }
+    }
+    return true;
+}
+
+// @brief
+// buses, n-input gates, registers, open ports, odd positions and holes left by removes
+static Netlist mixedCircuit()
+{
+    std::mt19937 rng(9);
+    Netlist netlist;
+    std::vector<int> bits, words;
+    for (int i = 0; i < 6; i++) bits.push_back(netlist.add(GATE_SWITCH, 0.5f * i, -3.25f));
+    for (int i = 0; i < 3; i++) words.push_back(netlist.add(GATE_SWITCH, 10, 20.0f * i, 16));
+    int clock = netlist.add(GATE_CLOCK, -1e6f, 1e-3f);
+    for (int i = 0; i < 40; i++)
+    {
+        int gate = netlist.add(i % 2 ? GATE_XOR : GATE_NAND, (float)i, 7, 1, 2 + i % 9);
+        for (int p = 0; p < netlist.inputCount(gate); p++)
+            if (rng() % 5) netlist.connect(gate, p, bits[rng() % bits.size()]);
+        bits.push_back(gate);
+    }
+    int sum = netlist.add(GATE_ADD, 1, 2, 16);
+    netlist.connect(sum, 0, words[0]);
+    netlist.connect(sum, 1, words[1]);
+    int reg = netlist.add(GATE_REG, 3, 4, 16);
+    netlist.connect(reg, 0, sum);
+    netlist.connect(reg, 1, clock);
+    netlist.connect(reg, 2, bits[7]);
+    int less = netlist.add(GATE_LT, 5, 6, 16);
+    netlist.connect(less, 0, reg);
+    netlist.connect(less, 1, words[2]);
+    netlist.connect(netlist.add(GATE_LIGHT, 8, 9), 0, less);
+    netlist.connect(netlist.add(GATE_LIGHT, 8, 19, 16), 0, reg);
+    netlist.remove(bits[2]);
+    netlist.remove(bits[20]);
+    netlist.remove(words[1]);
+    return netlist;
+}
+
+// @brief
+// json -> .dsim -> json keeps every node, wire and position, and the two json files are the same text
+static void roundTrip(const Netlist& original, const std::string& name)
+{
+    const std::string dsim = name + ".dsim";
+    const std::string json1 = name + ".1.json";
+    const std::string json2 = name + ".2.json";
+    CHECK(saveCircuitFile(original, json1));
+
+    Netlist fromJson, fromBinary, again;
+    CHECK(loadCircuitFile(fromJson, json1));
+    CHECK(saveCircuitFile(fromJson, dsim));
+    CHECK(loadCircuitFile(fromBinary, dsim));
+    CHECK(saveCircuitFile(fromBinary, json2));
+    CHECK(loadCircuitFile(again, json2));
+
+    CHECK(sameCircuit(original, fromJson));
+    CHECK(sameCircuit(original, fromBinary));
+    CHECK(sameCircuit(original, again));
+    CHECK(readFile(json1) == readFile(json2));
+    std::remove(dsim.c_str());
+    std::remove(json1.c_str());
+    std::remove(json2.c_str());
+}
+
+static void roundTrips()
+{
+    roundTrip(mixedCircuit(), "mixed");
+    for (const char* fixture : {"counter", "ripple", "accumulator", "nor_latch", "bus_ops", "nand3"})
+    {
+        Netlist netlist;
+        CHECK(loadCircuitFile(netlist, circuits + "/" + fixture + ".json"));
+        CHECK(netlist.size() > 0);
+        roundTrip(netlist, fixture);
+    }
+}
+
+// @brief
+// little endian field writer, files are built by hand to test what the loader accepts
+struct Bytes{
+    std::vector<uint8_t> data;
+
+    void u8(uint8_t v) { data.push_back(v); }
+    void u16(uint16_t v) { for (int b = 0; b < 2; b++) data.push_back((uint8_t)(v >> (8 * b))); }
+    void u32(uint32_t v) { for (int b = 0; b < 4; b++) data.push_back((uint8_t)(v >> (8 * b))); }
+    void u64(uint64_t v) { for (int b = 0; b < 8; b++) data.push_back((uint8_t)(v >> (8 * b))); }
+    void f32(float v) { uint32_t bits; std::memcpy(&bits, &v, 4); u32(bits); }
+    void put32(size_t at, uint32_t v) { for (int b = 0; b < 4; b++) data[at + b] = (uint8_t)(v >> (8 * b)); }
+    void put64(size_t at, uint64_t v) { for (int b = 0; b < 8; b++) data[at + b] = (uint8_t)(v >> (8 * b)); }
+};
+
+//byte offsets of the header fields
+enum { AT_VERSION = 4, AT_HEADER_SIZE = 6, AT_NODE_COUNT = 8, AT_INPUT_COUNT = 12,
+       AT_NODES = 16, AT_INPUTS = 24, AT_BYTE_ORDER = 32, HEADER_SIZE = 40, NODE_SIZE = 16 };
+
+// @brief
+// two switches into an AND (in the given width) and a light, as a file of that version
+// a version 1 file has no widths, its width bytes are 0
+static Bytes handMade(uint16_t version, uint8_t width)
+{
+    Bytes b;
+    b.data.insert(b.data.end(), {'D', 'S', 'I', 'M'});
+    b.u16(version);
+    b.u16(HEADER_SIZE);
+    b.u32(4);
+    b.u32(3);
+    b.u64(HEADER_SIZE);
+    b.u64(HEADER_SIZE + 4 * NODE_SIZE);
+    b.u32(0x01020304);
+    b.u32(0);
+    struct { uint8_t type, inputs, width; float x, y; uint32_t first; } nodes[4] = {
+        {GATE_SWITCH, 0, width, 0, 0, 0}, {GATE_SWITCH, 0, width, 0, 50, 0},
+        {GATE_AND, 2, width, 100, 25, 0}, {GATE_LIGHT, 1, width, 200, 25, 2}};
+    for (const auto& n : nodes)
+    {
+        b.u8(n.type);
+        b.u8(n.inputs);
+        b.u8(n.width);
+        b.u8(0);
+        b.f32(n.x);
+        b.f32(n.y);
+        b.u32(n.first);
+    }
+    b.u32(0);
+    b.u32(1);
+    b.u32(2);
+    return b;
+}
+
+static bool loadBytes(Netlist& netlist, const Bytes& bytes)
+{
+    writeFile("hand.dsim", bytes.data);
+    bool ok = loadCircuitBinary(netlist, "hand.dsim");
+    std::remove("hand.dsim");
+    return ok;
+}
+
+// @brief
+// what the writer puts in the file, byte for byte, whatever the byte order of the host
+static void writerIsLittleEndian()
+{
+    Netlist netlist;
+    int a = netlist.add(GATE_SWITCH, 0, 0);
+    int b = netlist.add(GATE_SWITCH, 0, 50);
+    int gate = netlist.add(GATE_AND, 100, 25);
+    netlist.connect(gate, 0, a);
+    netlist.connect(gate, 1, b);
+    netlist.connect(netlist.add(GATE_LIGHT, 200, 25), 0, gate);
+    CHECK(saveCircuitBinary(netlist, "written.dsim"));
+    std::vector<uint8_t> written = readFile("written.dsim");
+    std::remove("written.dsim");
+
+    Bytes expected = handMade(CIRCUIT_BINARY_VERSION, 1);
+    CHECK(written == expected.data);
+}
+
+// @brief
+// versions 1 and 2 had the same layout, 1 without widths
+static void olderVersions()
+{
+    Netlist v1, v2;
+    CHECK(loadBytes(v1, handMade(1, 0)));
+    CHECK(v1.size() == 4 && v1.type(2) == GATE_AND && v1.width(2) == 1);
+    CHECK(v1.input(2, 0) == 0 && v1.input(2, 1) == 1 && v1.input(3, 0) == 2);
+    CHECK(loadBytes(v2, handMade(2, 8)));
+    CHECK(v2.size() == 4 && v2.width(0) == 8 && v2.width(2) == 8 && v2.input(3, 0) == 2);
+}
+
+// @brief
+// every damaged file fails and leaves the netlist it was loaded into as it was
+static void rejectsDamagedFiles()
+{
+    const Bytes good = handMade(CIRCUIT_BINARY_VERSION, 1);
+    Netlist netlist;
+    netlist.add(GATE_LIGHT, 1, 2);
+    auto rejected = [&](const Bytes& bytes) {
+        bool ok = loadBytes(netlist, bytes);
+        return !ok && netlist.size() == 1 && netlist.type(0) == GATE_LIGHT;
+    };
+
+    //cut anywhere: no header, half a node record, the input table short by one entry
+    for (size_t size : {(size_t)0, (size_t)3, (size_t)HEADER_SIZE - 1, (size_t)HEADER_SIZE + NODE_SIZE / 2,
+                        good.data.size() - 4, good.data.size() - 1})
+    {
+        Bytes cut = good;
+        cut.data.resize(size);
+        CHECK(rejected(cut));
+    }
+
+    Bytes bad = good;
+    bad.data[0] = 'X';
+    CHECK(rejected(bad));
+    for (uint16_t version : {(uint16_t)0, (uint16_t)(CIRCUIT_BINARY_VERSION + 1)})
+    {
+        bad = good;
+        bad.data[AT_VERSION] = (uint8_t)version;
+        CHECK(rejected(bad));
+    }
+    bad = good;
+    bad.data[AT_HEADER_SIZE] = HEADER_SIZE - 8;
+    CHECK(rejected(bad));
+    bad = good;
+    bad.put32(AT_BYTE_ORDER, 0x04030201); //written by a host of the other byte order
+    CHECK(rejected(bad));
+
+    //sections outside the file, counts that would run past it or overflow a 32 bit product
+    bad = good;
+    bad.put64(AT_NODES, good.data.size() + 1);
+    CHECK(rejected(bad));
+    bad = good;
+    bad.put64(AT_INPUTS, ~0ull);
+    CHECK(rejected(bad));
+    bad = good;
+    bad.put64(AT_NODES, good.data.size() - NODE_SIZE);
+    CHECK(rejected(bad));
+    bad = good;
+    bad.put32(AT_NODE_COUNT, 0x20000000);
+    CHECK(rejected(bad));
+    bad = good;
+    bad.put32(AT_INPUT_COUNT, 0xFFFFFFFF);
+    CHECK(rejected(bad));
+
+    //a bus wider than a machine word
+    bad = good;
+    bad.data[HEADER_SIZE + 2 * NODE_SIZE + 2] = MAX_WIDTH + 1;
+    CHECK(rejected(bad));
+}
+
+// @brief
+// wires that point outside the tables are left open, the rest of the file still loads
+static void skipsBadWires()
+{
+    Bytes b = handMade(CIRCUIT_BINARY_VERSION, 1);
+    b.put32(HEADER_SIZE + 4 * NODE_SIZE + 4, 99);         //the AND's second source
+    b.put32(HEADER_SIZE + 3 * NODE_SIZE + 12, 3);         //the light's first input is past the table
+    Netlist netlist;
+    CHECK(loadBytes(netlist, b));
+    CHECK(netlist.size() == 4);
+    CHECK(netlist.input(2, 0) == 0 && netlist.input(2, 1) == -1);
+    CHECK(netlist.input(3, 0) == -1);
+}
+
+static bool loadText(Netlist& netlist, const std::string& text)
+{
+    writeFile("sax.json", std::vector<uint8_t>(text.begin(), text.end()));
+    bool ok = loadCircuitJson(netlist, "sax.json");
+    std::remove("sax.json");
+    return ok;
+}
+
+// @brief
+// the sax loader: wires to records further down, objects and arrays nested in a record or
+// standing in for one, and numbers that don't fit their field
+static void jsonLoader()
+{
+    Netlist netlist;
+    CHECK(loadText(netlist, R"([
+        {"id": 0, "type": "LIGHT", "x": 0, "y": 0, "width": 2, "src": 2},
+        {"id": 1, "type": "SWITCH", "x": 3, "y": 4,
+         "note": {"type": "AND", "x": 99, "width": 7, "in1": 5}, "tags": [1, {"width": 3}, [2]]},
+        {"id": 2, "type": "AND", "x": 1.5, "y": -2, "width": 2.0, "in1": 1, "in2": 4},
+        [{"type": "NOT", "src": 1}],
+        {"id": 4, "type": "SWITCH", "width": 2, "extra": null},
+        {"id": 5, "type": "BOGUS", "src": 1},
+        {"id": 6, "type": "OR", "in1": -1, "in2": 1, "in3": 1}
+    ])"));
+    CHECK(netlist.size() == 5);
+    //the light reads the AND declared after it, the AND reads the switch after the array
+    CHECK(netlist.type(0) == GATE_LIGHT && netlist.input(0, 0) == 2);
+    CHECK(netlist.type(1) == GATE_SWITCH && netlist.width(1) == 1 && netlist.x(1) == 3 && netlist.y(1) == 4);
+    CHECK(netlist.type(2) == GATE_AND && netlist.width(2) == 2 && netlist.x(2) == 1.5f);
+    //widths differ, so the first wire of the AND stays open
+    CHECK(netlist.input(2, 0) == -1 && netlist.input(2, 1) == 3);
+    CHECK(netlist.type(3) == GATE_SWITCH && netlist.width(3) == 2);
+    CHECK(netlist.type(4) == GATE_OR && netlist.inputCount(4) == 3);
+    CHECK(netlist.input(4, 0) == -1 && netlist.input(4, 1) == 1 && netlist.input(4, 2) == 1);
+
+    //every one of these fails the whole load and leaves the netlist alone
+    const char* bad[] = {
+        R"([{"type": "SWITCH", "width": 1e30}])",
+        R"([{"type": "SWITCH", "width": 1.5}])",
+        R"([{"type": "SWITCH", "width": 0}])",
+        R"([{"type": "SWITCH", "width": 65}])",
+        R"([{"type": "SWITCH", "width": -3e9}])",
+        R"([{"type": "SWITCH"}, {"type": "NOT", "src": 0.5}])",
+        R"([{"type": "SWITCH"}, {"type": "NOT", "src": 1e30}])",
+        R"([{"type": "SWITCH"}, {"type": "NOT", "src": -1e30}])",
+        R"([{"type": "SWITCH"}, {"type": "NOT", "src": 18446744073709551615}])",
+        R"([{"type": "SWITCH", "x": 1e300}])",
+        R"([{"type": "SWITCH", "y": -1e39}])",
+        R"([{"type": "SWITCH"},)",
+        R"({"type": "SWITCH"})",
+    };
+    for (const char* text : bad)
+    {
+        bool ok = loadText(netlist, text);
+        CHECK(!ok);
+        if (ok) std::fprintf(stderr, "  loaded: %s\n", text);
+    }
+    CHECK(netlist.size() == 5 && netlist.type(4) == GATE_OR);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1) circuits = argv[1];
+    roundTrips();
+    writerIsLittleEndian();
+    olderVersions();
+    rejectsDamagedFiles();
+    skipsBadWires();
+    jsonLoader();
+    if (failures == 0) std::printf("all circuit io tests passed\n");
+    return failures;
+}
@@ -0,0 +1,364 @@
+// regression tests of the simulation core
+#include "check.hpp"
+#include <netlist.hpp>
+#include <simulator.hpp>
+#include <sim_worker.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+static std::vector<int32_t> sorted(std::vector<int32_t> nets)
+{
+    std::sort(nets.begin(), nets.end());
+    return nets;
+}
+
+static bool sameNets(const Simulator& a, const Simulator& b, int count)
+{
+    for (int net = 0; net < count; net++)
+    {
+        if (a.word(net) != b.word(net)) return false;
+    }
+    return true;
+}
+
+// @brief
+// a dff whose clock is a switch, there is no clock source in the circuit
+static void dffClockedBySwitch()
+{
+    Netlist netlist;
+    int d = netlist.add(GATE_SWITCH, 0, 0);
+    int clk = netlist.add(GATE_SWITCH, 0, 0);
+    int dff = netlist.add(GATE_DFF, 0, 0);
+    int light = netlist.add(GATE_LIGHT, 0, 0);
+    netlist.connect(dff, 0, d);
+    netlist.connect(dff, 1, clk);
+    netlist.connect(light, 0, dff);
+
+    Simulator simulator;
+    simulator.compile(netlist);
+    simulator.step();
+    CHECK(!simulator.isRunning());
+
+    //a rising edge on the clock switch alone has to wake the simulator and load d
+    simulator.setSource(d, 1);
+    simulator.step();
+    CHECK(simulator.word(dff) == 0);
+    simulator.setSource(clk, 1);
+    CHECK(simulator.isRunning());
+    simulator.step();
+    CHECK(simulator.word(dff) == 1);
+    CHECK(simulator.word(light) == 1);
+    CHECK(!simulator.isRunning());
+
+    //the falling edge and a change of d without an edge load nothing
+    simulator.setSource(clk, 0);
+    simulator.setSource(d, 0);
+    while (simulator.isRunning()) simulator.step();
+    CHECK(simulator.word(dff) == 1);
+    simulator.setSource(clk, 1);
+    while (simulator.isRunning()) simulator.step();
+    CHECK(simulator.word(dff) == 0);
+}
+
+// @brief
+// the same circuit through the simulation thread, the way the editor drives it
+static void dffClockedBySwitchOnWorker()
+{
+    Netlist netlist;
+    int d = netlist.add(GATE_SWITCH, 0, 0);
+    int clk = netlist.add(GATE_SWITCH, 0, 0);
+    int dff = netlist.add(GATE_DFF, 0, 0);
+    netlist.connect(dff, 0, d);
+    netlist.connect(dff, 1, clk);
+    netlist.setValue(d, 1);
+
+    SimWorker worker;
+    worker.setTickRate(0);
+    worker.start();
+    worker.load(netlist);
+    worker.setSwitch(clk, 1);
+
+    bool loaded = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!loaded && std::chrono::steady_clock::now() < deadline)
+    {
+        if (worker.acquire() && worker.snapshot().state(dff)) loaded = true;
+        else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    worker.stop();
+    CHECK(loaded);
+}
+
+// @brief
+// a chain of NOT gates added from its light back to its switch: compile() orders it by level,
+// so one evaluate() settles all of it whatever order the nodes were added in
+static void chainSettlesInOnePass()
+{
+    const int LENGTH = 51;
+    Netlist netlist;
+    int light = netlist.add(GATE_LIGHT, 0, 0);
+    std::vector<int> chain(LENGTH);
+    for (int k = LENGTH - 1; k >= 0; k--) chain[k] = netlist.add(GATE_NOT, 0, 0);
+    int in = netlist.add(GATE_SWITCH, 0, 0);
+    netlist.connect(chain[0], 0, in);
+    for (int k = 1; k < LENGTH; k++) netlist.connect(chain[k], 0, chain[k - 1]);
+    netlist.connect(light, 0, chain[LENGTH - 1]);
+
+    Simulator simulator;
+    simulator.compile(netlist);
+    CHECK(simulator.levelCount() >= LENGTH + 1);
+    simulator.evaluate();
+    CHECK(!simulator.hasPending());
+    for (int k = 0; k < LENGTH; k++) CHECK(simulator.word(chain[k]) == (k % 2 == 0 ? 1u : 0u));
+    CHECK(simulator.word(light) == 1);
+    CHECK((int)simulator.getChanged().size() == (LENGTH + 1) / 2 + 1);
+
+    simulator.setSource(in, 1);
+    simulator.evaluate();
+    for (int k = 0; k < LENGTH; k++) CHECK(simulator.word(chain[k]) == (k % 2 == 0 ? 0u : 1u));
+    CHECK(simulator.word(light) == 0);
+}
+
+// @brief
+// settle() after a switch moves ends where a full evaluate() does, and only touches the gates
+// downstream of that switch
+static void settleFollowsTheFanoutCone()
+{
+    //two chains of gates, a and b, joined into one AND, each with a light at its end
+    const int LENGTH = 8;
+    Netlist netlist;
+    int inA = netlist.add(GATE_SWITCH, 0, 0);
+    int inB = netlist.add(GATE_SWITCH, 0, 0);
+    std::vector<int> a, b;
+    for (int k = 0; k < LENGTH; k++)
+    {
+        a.push_back(netlist.add(k % 2 ? GATE_NOT : GATE_XOR, 0, 0));
+        b.push_back(netlist.add(k % 2 ? GATE_NOT : GATE_XNOR, 0, 0));
+        netlist.connect(a[k], 0, k ? a[k - 1] : inA);
+        netlist.connect(b[k], 0, k ? b[k - 1] : inB);
+        if (k % 2 == 0)
+        {
+            netlist.connect(a[k], 1, inB);
+            netlist.connect(b[k], 1, k ? a[k - 1] : inA);
+        }
+    }
+    int join = netlist.add(GATE_AND, 0, 0);
+    netlist.connect(join, 0, a[LENGTH / 2]);
+    netlist.connect(join, 1, b[LENGTH - 1]);
+    int lightA = netlist.add(GATE_LIGHT, 0, 0);
+    int lightB = netlist.add(GATE_LIGHT, 0, 0);
+    int lightJoin = netlist.add(GATE_LIGHT, 0, 0);
+    netlist.connect(lightA, 0, a[LENGTH - 1]);
+    netlist.connect(lightB, 0, b[LENGTH - 1]);
+    netlist.connect(lightJoin, 0, join);
+
+    Simulator events;
+    Simulator full;
+    events.compile(netlist);
+    full.compile(netlist);
+    CHECK(events.settle()); //everything is pending after compile(), the first settle() is a full pass
+    full.evaluate();
+    CHECK(sameNets(events, full, netlist.size()));
+
+    for (int round = 0; round < 4; round++)
+    {
+        const int in = round % 2 ? inB : inA;
+        events.setSource(in, events.word(in) ^ 1);
+        full.setSource(in, full.word(in) ^ 1);
+        events.settle();
+        full.evaluate();
+        CHECK(!events.hasPending());
+        CHECK(sameNets(events, full, netlist.size()));
+        CHECK(sorted(events.getChanged()) == sorted(full.getChanged()));
+    }
+
+    //b's last gate is forced wrong, only its light follows; a's switch doesn't reach that gate,
+    //so a settle() for it leaves the wrong value alone where a full pass would recompute it
+    const int last = b[LENGTH - 1];
+    const uint64_t right = events.word(last);
+    events.setSource(last, right ^ 1);
+    events.settle();
+    CHECK(events.word(lightB) == (right ^ 1));
+    events.setSource(inA, events.word(inA) ^ 1);
+    events.settle();
+    CHECK(events.word(last) == (right ^ 1));
+    for (int32_t net : events.getChanged()) CHECK(net != last && net != lightB && net != inB);
+    //b's XNORs read a too, the flip enters b at its first gate and cancels out at the third one
+    CHECK(std::find(events.getChanged().begin(), events.getChanged().end(), b[0]) != events.getChanged().end());
+    CHECK(events.word(lightA) == events.word(a[LENGTH - 1]));
+    events.evaluate();
+    CHECK(events.word(last) == right);
+}
+
+// @brief
+// a loop that never settles is swept LOOP_SWEEP_LIMIT times, flagged and left alone until
+// something reaches it again; one that settles is never flagged
+static void oscillatingLoops()
+{
+    Netlist netlist;
+    int ring = netlist.add(GATE_NOT, 0, 0);
+    CHECK(netlist.connect(ring, 0, ring));
+    //a NAND fed back into itself oscillates only while its enable is high
+    int enable = netlist.add(GATE_SWITCH, 0, 0);
+    int gated = netlist.add(GATE_NAND, 0, 0);
+    netlist.connect(gated, 0, enable);
+    netlist.connect(gated, 1, gated);
+    //a NOR latch settles from any input
+    int set = netlist.add(GATE_SWITCH, 0, 0);
+    int reset = netlist.add(GATE_SWITCH, 0, 0);
+    int q = netlist.add(GATE_NOR, 0, 0);
+    int nq = netlist.add(GATE_NOR, 0, 0);
+    netlist.connect(q, 0, reset);
+    netlist.connect(q, 1, nq);
+    netlist.connect(nq, 0, q);
+    netlist.connect(nq, 1, set);
+
+    Simulator simulator;
+    simulator.compile(netlist);
+    CHECK(simulator.loopCount() == 3);
+    const Program& program = simulator.getProgram();
+    auto loopOf = [&](int net) {
+        for (int32_t slot = 0; slot < simulator.gateCount(); slot++)
+            if (program.target[slot] == net) return program.slotLoop[slot];
+        return -1;
+    };
+    const int ringLoop = loopOf(ring);
+    const int gatedLoop = loopOf(gated);
+    const int latchLoop = loopOf(q);
+    CHECK(ringLoop >= 0 && gatedLoop >= 0 && latchLoop >= 0 && loopOf(nq) == latchLoop);
+
+    simulator.settle();
+    CHECK(simulator.isOscillating(ringLoop));
+    CHECK(!simulator.isOscillating(gatedLoop));
+    CHECK(!simulator.isOscillating(latchLoop));
+    CHECK(simulator.oscillatingCount() == 1);
+    //the sweeps are capped, the oscillation doesn't keep the simulator busy
+    CHECK(!simulator.hasPending());
+    CHECK(!simulator.isRunning());
+
+    simulator.setSource(enable, 1);
+    simulator.settle();
+    CHECK(simulator.isOscillating(gatedLoop));
+    CHECK(simulator.oscillatingCount() == 2);
+    CHECK(!simulator.isRunning());
+
+    simulator.setSource(enable, 0);
+    simulator.settle();
+    CHECK(!simulator.isOscillating(gatedLoop));
+    CHECK(simulator.word(gated) == 1);
+
+    simulator.setSource(set, 1);
+    simulator.settle();
+    simulator.setSource(set, 0);
+    simulator.settle();
+    CHECK(simulator.word(q) == 1 && simulator.word(nq) == 0);
+    simulator.setSource(reset, 1);
+    simulator.settle();
+    CHECK(simulator.word(q) == 0 && simulator.word(nq) == 1);
+    CHECK(!simulator.isOscillating(latchLoop));
+    CHECK(simulator.oscillatingCount() == 1);
+
+    //a full pass sweeps every loop again and comes to the same flags
+    simulator.evaluate();
+    CHECK(simulator.isOscillating(ringLoop) && simulator.oscillatingCount() == 1);
+    CHECK(!simulator.isRunning());
+}
+
+// @brief
+// levels wider than PARALLEL_MIN_WIDTH are split across the pool, the values and the set of
+// changed nets have to match one thread exactly, only the order of getChanged() may differ
+static void parallelMatchesSerial()
+{
+    const int SWITCHES = 16;
+    const int WIDE = 2 * PARALLEL_MIN_WIDTH + 123; //not a multiple of any chunk
+    const GateType kinds[] = {GATE_AND, GATE_OR, GATE_XOR, GATE_NAND, GATE_NOR, GATE_XNOR};
+    std::mt19937 rng(16);
+
+    Netlist netlist;
+    std::vector<int> switches, first, second;
+    for (int i = 0; i < SWITCHES; i++) switches.push_back(netlist.add(GATE_SWITCH, 0, 0));
+    //every gate of a layer reads the one before, so each layer is one level
+    for (int i = 0; i < WIDE; i++)
+    {
+        int ports = i % 7 == 0 ? 5 : 2;
+        int gate = netlist.add(kinds[rng() % 6], 0, 0, 1, ports);
+        for (int p = 0; p < ports; p++) netlist.connect(gate, p, switches[rng() % SWITCHES]);
+        first.push_back(gate);
+    }
+    for (int i = 0; i < WIDE; i++)
+    {
+        int gate = netlist.add(kinds[rng() % 6], 0, 0);
+        netlist.connect(gate, 0, first[rng() % WIDE]);
+        netlist.connect(gate, 1, first[rng() % WIDE]);
+        second.push_back(gate);
+    }
+    //a few latches on the wide level, their loops are swept after the parallel part
+    for (int i = 0; i < 8; i++)
+    {
+        int a = netlist.add(GATE_NOR, 0, 0);
+        int b = netlist.add(GATE_NOR, 0, 0);
+        netlist.connect(a, 0, first[rng() % WIDE]);
+        netlist.connect(a, 1, b);
+        netlist.connect(b, 0, a);
+        netlist.connect(b, 1, first[rng() % WIDE]);
+    }
+
+    Simulator serial;
+    Simulator parallel;
+    parallel.setThreadCount(4);
+    CHECK(parallel.threadCount() == 4);
+    serial.compile(netlist);
+    parallel.compile(netlist);
+
+    const Program& program = parallel.getProgram();
+    int32_t widest = 0;
+    for (int32_t l = 0; l < program.numLevels; l++)
+        widest = std::max(widest, program.levelStart[l + 1] - program.levelStart[l]);
+    CHECK(widest >= PARALLEL_MIN_WIDTH);
+
+    for (int i = 0; i < SWITCHES; i += 3)
+    {
+        serial.setSource(switches[i], 1);
+        parallel.setSource(switches[i], 1);
+    }
+    serial.evaluate();
+    parallel.evaluate();
+    CHECK(sameNets(serial, parallel, netlist.size()));
+    CHECK(sorted(serial.getChanged()) == sorted(parallel.getChanged()));
+
+    //every switch flipping schedules the whole first layer, a few of them only part of it
+    for (int round = 0; round < 6; round++)
+    {
+        for (int i = 0; i < SWITCHES; i++)
+        {
+            if (round % 2 == 0 || rng() % 4 == 0)
+            {
+                uint64_t v = serial.word(switches[i]) ^ 1;
+                serial.setSource(switches[i], v);
+                parallel.setSource(switches[i], v);
+            }
+        }
+        bool a = serial.settle();
+        bool b = parallel.settle();
+        CHECK(a == b);
+        CHECK(!parallel.hasPending());
+        CHECK(sameNets(serial, parallel, netlist.size()));
+        CHECK(sorted(serial.getChanged()) == sorted(parallel.getChanged()));
+    }
+}
+
+int main()
+{
+    dffClockedBySwitch();
+    dffClockedBySwitchOnWorker();
+    chainSettlesInOnePass();
+    settleFollowsTheFanoutCone();
+    oscillatingLoops();
+    parallelMatchesSerial();
+    if (failures == 0) std::printf("all engine tests passed\n");
+    return failures;
+}
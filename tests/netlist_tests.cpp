@@ -0,0 +1,152 @@
+// the netlist's reverse index (the readers of every node) under random edits
+#include "check.hpp"
+#include <netlist.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+// @brief
+// forEachReader of every node lists exactly the ports whose input is that node, each once,
+// and no port of a live node is still wired to a removed one
+static bool readersMatchInputs(const Netlist& netlist)
+{
+    bool ok = true;
+    for (int node = 0; node < netlist.size(); node++)
+    {
+        std::vector<std::pair<int, int>> expected, listed;
+        for (int reader = 0; reader < netlist.size(); reader++)
+        {
+            if (!netlist.isAlive(reader)) continue;
+            for (int p = 0; p < netlist.inputCount(reader); p++)
+            {
+                int source = netlist.input(reader, p);
+                if (source == node) expected.push_back({reader, p});
+                if (source >= 0 && (source >= netlist.size() || !netlist.isAlive(source))) ok = false;
+            }
+        }
+        netlist.forEachReader(node, [&](int reader, int port) { listed.push_back({reader, port}); });
+        std::sort(listed.begin(), listed.end());
+        if (listed != expected || (!netlist.isAlive(node) && !listed.empty()))
+        {
+            std::fprintf(stderr, "  node %d: %zu readers listed, %zu wired\n", node, listed.size(), expected.size());
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// @brief
+// connect, reconnect, open, resize n-input gates, change widths and remove and re-add nodes at
+// random, the index has to agree with the inputs after every edit
+static void randomEdits()
+{
+    const GateType kinds[] = {GATE_SWITCH, GATE_AND, GATE_OR, GATE_NOT, GATE_XOR, GATE_MUX, GATE_NAND,
+                              GATE_DFF, GATE_REG, GATE_LIGHT};
+    std::mt19937 rng(7);
+    Netlist netlist;
+    auto anyLive = [&]() {
+        for (;;)
+        {
+            int node = (int)(rng() % netlist.size());
+            if (netlist.isAlive(node)) return node;
+        }
+    };
+    for (int i = 0; i < 40; i++) netlist.add(kinds[rng() % 10], 0, 0, 1 + (rng() % 4 == 0 ? 3 : 0));
+
+    int wired = 0;
+    for (int step = 0; step < 4000; step++)
+    {
+        const int op = (int)(rng() % 10);
+        if (op < 5) //connect or reconnect a port, sometimes open it
+        {
+            int node = anyLive();
+            if (netlist.inputCount(node) == 0) continue;
+            int port = (int)(rng() % netlist.inputCount(node));
+            int source = rng() % 6 == 0 ? -1 : anyLive();
+            int before = netlist.input(node, port);
+            if (netlist.connect(node, port, source))
+            {
+                CHECK(netlist.input(node, port) == source);
+                wired++;
+            }
+            else
+            {
+                CHECK(netlist.input(node, port) == before);
+            }
+        }
+        else if (op < 7) //grow or shrink an n-input gate, growing past its slots moves them
+        {
+            int node = anyLive();
+            bool variadic = gateInfo(netlist.type(node)).variadic;
+            CHECK(netlist.setInputCount(node, 2 + (int)(rng() % 12)) == variadic);
+        }
+        else if (op < 8)
+        {
+            int node = anyLive();
+            CHECK(netlist.setWidth(node, rng() % 2 ? 1 : 4));
+        }
+        else if (op < 9 && netlist.size() > 10)
+        {
+            netlist.remove(anyLive());
+        }
+        else
+        {
+            int node = netlist.add(kinds[rng() % 10], 0, 0, rng() % 2 ? 1 : 4, 2 + (int)(rng() % 5));
+            //a reused index starts without readers or inputs
+            int readers = 0;
+            netlist.forEachReader(node, [&](int, int) { readers++; });
+            CHECK(readers == 0);
+            for (int p = 0; p < netlist.inputCount(node); p++) CHECK(netlist.input(node, p) == -1);
+        }
+
+        if (!readersMatchInputs(netlist))
+        {
+            std::fprintf(stderr, "  after step %d (op %d)\n", step, op);
+            CHECK(false);
+            return;
+        }
+    }
+    CHECK(wired > 500);
+}
+
+// @brief
+// the same by hand: a removed node's readers are opened, its index comes back clean
+static void removeOpensReaders()
+{
+    Netlist netlist;
+    int a = netlist.add(GATE_SWITCH, 0, 0);
+    int b = netlist.add(GATE_SWITCH, 0, 0);
+    int gate = netlist.add(GATE_AND, 0, 0, 1, 4);
+    CHECK(netlist.connect(gate, 0, a) && netlist.connect(gate, 1, b) && netlist.connect(gate, 3, a));
+    int light = netlist.add(GATE_LIGHT, 0, 0);
+    CHECK(netlist.connect(light, 0, gate));
+
+    netlist.remove(a);
+    CHECK(netlist.input(gate, 0) == -1 && netlist.input(gate, 1) == b && netlist.input(gate, 3) == -1);
+    int again = netlist.add(GATE_NOT, 0, 0);
+    CHECK(again == a);
+    CHECK(netlist.input(gate, 0) == -1);
+
+    //growing past the slots moves the wires, the old slots must not list the gate any more
+    CHECK(netlist.setInputCount(gate, 20));
+    CHECK(netlist.input(gate, 1) == b);
+    CHECK(netlist.connect(gate, 19, b));
+    int readsB = 0;
+    netlist.forEachReader(b, [&](int reader, int port) { readsB++; CHECK(reader == gate && (port == 1 || port == 19)); });
+    CHECK(readsB == 2);
+
+    //a new width opens the wires on both sides
+    CHECK(netlist.setWidth(gate, 8));
+    CHECK(netlist.input(gate, 1) == -1 && netlist.input(light, 0) == -1);
+    CHECK(readersMatchInputs(netlist));
+}
+
+int main()
+{
+    removeOpensReaders();
+    randomEdits();
+    if (failures == 0) std::printf("all netlist tests passed\n");
+    return failures;
+}